@@ -0,0 +1,704 @@
+/*
+  bench - host microbenchmarks for the CPU side of the demo
+
+    bench [-o out.json] [-b baseline.json] [-t threshold]
+
+  Prints one JSON record per kernel with the median and p95 time of one
+  operation and the number of timed samples. With -b, each median is
+  compared with the baseline entry of the same name and the run fails
+  (exit 1) when any is slower by more than the threshold (default 0.15).
+
+  Kernels that run on the FPU or the store queues on the console are
+  timed through their C counterparts: math_ref.c for math.s and a
+  memory sink for sq_cpy(). Palette RAM is src/hal_host.c's.
+
+  Before timing anything, every formula is checked against its
+  reference, and every kernel and FRACTAL_AUTO against the scalar
+  kernel at every LOD level, which at level 0 must be compute_texture();
+  a mismatch fails the run.
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dc_ta_instructions.h"
+#include "draw.h"
+#include "fractal.h"
+#include "lod.h"
+#include "math.h"
+#include "palette.h"
+#include "scene.h"
+#include "vram.h"
+
+#define MIN_SAMPLES 9
+#define MAX_SAMPLES 2000
+#define MIN_TIME    0.25
+
+static volatile uint32_t sink;
+static uint16_t texture[256*256/2];
+static uint8_t  counts[256][256];
+
+
+
+/*
+ Kernels
+ */
+
+static void bench_mandelbrot()
+{
+    uint32_t acc = 0;
+
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j++)
+            acc += compute_texture(i, j, 0);
+
+    sink = acc;
+}
+
+static void bench_julia()
+{
+    uint32_t acc = 0;
+
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j++)
+            acc += compute_texture(i, j, 1);
+
+    sink = acc;
+}
+
+/* Each formula's specialized kernel against a hand-written loop for the
+   same formula, which it should match in speed and counts */
+static uint32_t ref_mandelbrot(int x, int y)
+{
+    float c_re = (x-128)*(1.0/16384)-1.313747, c_im = (y-128)*(1.0/16384)-0.073227;
+    float z_re = 0.0, z_im = 0.0;
+    int n = -1;
+
+    do {
+        float t = z_re;
+        z_re = z_re*z_re - z_im*z_im + c_re;
+        z_im = 2*t*z_im + c_im;
+    } while(++n<255 && z_re*z_re+z_im*z_im<=2.0);
+
+    return n;
+}
+
+static uint32_t ref_julia(int x, int y)
+{
+    float z_re = (x-128)*(1.0/16384)-1.313747, z_im = (y-128)*(1.0/16384)-0.073227;
+    float c_re = -1.313747, c_im = -0.073227;
+    int n = -1;
+
+    do {
+        float t = z_re;
+        z_re = z_re*z_re - z_im*z_im + c_re;
+        z_im = 2*t*z_im + c_im;
+    } while(++n<255 && z_re*z_re+z_im*z_im<=2.0);
+
+    return n;
+}
+
+static uint32_t ref_multibrot3(int x, int y)
+{
+    float c_re = (x-128)*(1.0/96), c_im = (y-128)*(1.0/96);
+    float z_re = 0.0, z_im = 0.0;
+    int n = -1;
+
+    do {
+        float r2 = z_re*z_re, i2 = z_im*z_im, t = z_re*(r2 - 3*i2);
+        z_im = z_im*(3*r2 - i2) + c_im;
+        z_re = t + c_re;
+    } while(++n<255 && z_re*z_re+z_im*z_im<=4.0f);
+
+    return n;
+}
+
+static uint32_t ref_multibrot4(int x, int y)
+{
+    float c_re = (x-128)*(1.0/100), c_im = (y-128)*(1.0/100);
+    float z_re = 0.0, z_im = 0.0;
+    int n = -1;
+
+    do {
+        float a = z_re*z_re - z_im*z_im, b = 2*z_re*z_im;
+        z_re = a*a - b*b + c_re;
+        z_im = 2*a*b + c_im;
+    } while(++n<255 && z_re*z_re+z_im*z_im<=4.0f);
+
+    return n;
+}
+
+static uint32_t ref_burning_ship(int x, int y)
+{
+    float c_re = (x-128)*(1.0/80)-0.45, c_im = (y-128)*(1.0/80)-0.5;
+    float z_re = 0.0, z_im = 0.0;
+    int n = -1;
+
+    do {
+        float r2 = z_re*z_re, i2 = z_im*z_im;
+        z_im = 2*fabsf(z_re*z_im) + c_im;
+        z_re = r2 - i2 + c_re;
+    } while(++n<255 && z_re*z_re+z_im*z_im<=4.0f);
+
+    return n;
+}
+
+static uint32_t ref_tricorn(int x, int y)
+{
+    float c_re = (x-128)*(1.0/90)-0.3, c_im = (y-128)*(1.0/90);
+    float z_re = 0.0, z_im = 0.0;
+    int n = -1;
+
+    do {
+        float r2 = z_re*z_re, i2 = z_im*z_im;
+        z_im = -2*z_re*z_im + c_im;
+        z_re = r2 - i2 + c_re;
+    } while(++n<255 && z_re*z_re+z_im*z_im<=4.0f);
+
+    return n;
+}
+
+static uint32_t (*const references[FRACTAL_FORMULAS])(int x, int y) = {
+    ref_mandelbrot, ref_julia, ref_multibrot3, ref_multibrot4, ref_burning_ship, ref_tricorn,
+};
+
+static void bench_formula(int formula)
+{
+    uint32_t acc = 0;
+
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j++)
+            acc += compute_texture(i, j, formula);
+
+    sink = acc;
+}
+
+static void bench_reference(int formula)
+{
+    uint32_t (*ref)(int x, int y) = references[formula];
+    uint32_t acc = 0;
+
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j++)
+            acc += ref(i, j);
+
+    sink = acc;
+}
+
+static void bench_multibrot3()     { bench_formula(FRACTAL_MULTIBROT3); }
+static void bench_multibrot4()     { bench_formula(FRACTAL_MULTIBROT4); }
+static void bench_burning_ship()   { bench_formula(FRACTAL_BURNING_SHIP); }
+static void bench_tricorn()        { bench_formula(FRACTAL_TRICORN); }
+static void bench_ref_mandelbrot() { bench_reference(FRACTAL_MANDELBROT); }
+static void bench_ref_julia()      { bench_reference(FRACTAL_JULIA); }
+static void bench_ref_multibrot3() { bench_reference(FRACTAL_MULTIBROT3); }
+static void bench_ref_multibrot4() { bench_reference(FRACTAL_MULTIBROT4); }
+static void bench_ref_burning_ship() { bench_reference(FRACTAL_BURNING_SHIP); }
+static void bench_ref_tricorn()    { bench_reference(FRACTAL_TRICORN); }
+
+/* The store side of build_texture() on precomputed counts */
+static void bench_twiddle()
+{
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j+=2)
+            texture[twiddletab[i]|(twiddletab[j]>>1)] = counts[i][j] | (counts[i][j+1]<<8);
+
+    sink = texture[1];
+}
+
+static void bench_build_plain()
+{
+    fractal_refine = 0;
+    fractal_build(texture, 0);
+    fractal_refine = 4;
+}
+
+/* Each kernel on its own, and picked per block by timing */
+static void bench_build_kernel(int kernel)
+{
+    fractal_refine = 0;
+    fractal_kernel = kernel;
+    fractal_build(texture, 0);
+    fractal_kernel = FRACTAL_AUTO;
+    fractal_refine = 4;
+}
+
+static void bench_kernel_scalar() { bench_build_kernel(0); }
+static void bench_kernel_pair()   { bench_build_kernel(1); }
+static void bench_unroll2()       { bench_build_kernel(2); }
+static void bench_unroll4()       { bench_build_kernel(3); }
+static void bench_unroll8()       { bench_build_kernel(4); }
+static void bench_unroll16()      { bench_build_kernel(5); }
+
+static void bench_build_adaptive()
+{
+    fractal_build(texture, 0);
+}
+
+/* What adaptive supersampling replaces: four samples for every texel */
+static void bench_build_uniform4x()
+{
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j+=2)
+        {
+            uint32_t a = 0, b = 0;
+
+            for(int k=0; k<4; k++) {
+                float dx = k & 1 ? 0.25f : -0.25f, dy = k & 2 ? 0.25f : -0.25f;
+                a += compute_sample(i + dx, j + dy, 0);
+                b += compute_sample(i + dx, j + 1 + dy, 0);
+            }
+
+            texture[twiddletab[i]|(twiddletab[j]>>1)] = (a + 2) / 4 | ((b + 2) / 4) << 8;
+        }
+}
+
+static int frame;
+
+static void setup_matrix()
+{
+    clear_matrix();
+    apply_matrix(&screenview_matrix);
+    apply_matrix(&projection_matrix);
+    apply_matrix(&translation_matrix);
+    rotate_x(frame);
+    rotate_y(frame);
+    rotate_z(frame);
+    frame++;
+}
+
+static void bench_apply_matrix()
+{
+    setup_matrix();
+}
+
+static void bench_transform_coords()
+{
+    transform_coords(coords, trans_coords, 8);
+    sink = trans_coords[7][0];
+}
+
+/* sq_cpy() with the store queue replaced by a cached buffer */
+static uint32_t sq_src[8*64];
+static uint32_t sq_sink[8*64];
+
+static void *sq_cpy_sink(void *dest, const void *src, int n)
+{
+    volatile uint32_t *d = (volatile uint32_t*)dest;
+    const uint32_t *s = (const uint32_t*)src;
+
+    n >>= 5;
+
+    while(n--) {
+        d[0] = *(s++);
+        d[1] = *(s++);
+        d[2] = *(s++);
+        d[3] = *(s++);
+        d[4] = *(s++);
+        d[5] = *(s++);
+        d[6] = *(s++);
+        d[7] = *(s++);
+        d += 8;
+    }
+
+    return dest;
+}
+
+static void bench_sq_cpy()
+{
+    sq_cpy_sink(sq_sink, sq_src, sizeof(sq_src));
+}
+
+/* The palette work: pal_init(), each bank's gradient from its own
+   keyframes and the upload of all PAL_BANKS, and pal_update(), the per
+   frame rotate and crossfade, writing to palette RAM simulated by
+   src/hal_host.c */
+static void bench_palette_init()
+{
+    pal_init();
+
+    sink = pal_banks[sink % PAL_BANKS][sink & 255];
+}
+
+static void bench_palette_update()
+{
+    static int frame;
+
+    pal_update(frame++);
+}
+
+/* Everything main() does per frame before waiting on the TA: the cube
+   of src/scene.c, its faces through the draw list with the same atlas
+   and palettes */
+static const uint32_t end_of_list[8];
+
+static void send_sink(const void *packet)
+{
+    sq_cpy_sink(sq_sink, packet, 32);
+}
+
+/* The cube of src/scene.c moved by (dx, dy) on screen */
+static void draw_moved_cube(float dx, float dy)
+{
+    float c[8][3];
+
+    for(int k = 0; k < 8; k++) {
+        c[k][0] = trans_coords[k][0] + dx;
+        c[k][1] = trans_coords[k][1] + dy;
+        c[k][2] = trans_coords[k][2];
+    }
+
+    draw_cube(c);
+}
+
+static void bench_frame()
+{
+    scene_transform(frame++);
+
+    draw_begin();
+    draw_cube(trans_coords);
+    draw_end();
+    sq_cpy_sink(sq_sink, end_of_list, 32);
+}
+
+/* SCENE_CUBES copies of the cube on a grid, the same six states each */
+#define SCENE_CUBES 64
+
+static void draw_scene()
+{
+    scene_transform(frame++);
+
+    draw_begin();
+    for(int k = 0; k < SCENE_CUBES; k++)
+        draw_moved_cube((k % 8 - 3.5f) * 64, (k / 8 - 3.5f) * 48);
+    draw_end();
+    sq_cpy_sink(sq_sink, end_of_list, 32);
+}
+
+static void bench_scene_unsorted()
+{
+    draw_sorted = 0;
+    draw_scene();
+    draw_sorted = 1;
+}
+
+static void bench_scene_sorted()
+{
+    draw_scene();
+}
+
+static void bench_scene_strips()
+{
+    draw_sprites = 0;
+    draw_scene();
+    draw_sprites = 1;
+}
+
+
+
+/*
+ Runner
+ */
+
+typedef struct
+{
+    const char *name;
+    void (*fn)();
+    int batch;          /* calls per timed sample */
+} bench;
+
+static const bench benches[] = {
+    { "compute_texture_mandelbrot", bench_mandelbrot,        1 },
+    { "compute_texture_julia",      bench_julia,             1 },
+    { "compute_texture_multibrot3", bench_multibrot3,        1 },
+    { "compute_texture_multibrot4", bench_multibrot4,        1 },
+    { "compute_texture_burning_ship", bench_burning_ship,    1 },
+    { "compute_texture_tricorn",    bench_tricorn,           1 },
+    { "reference_mandelbrot",       bench_ref_mandelbrot,    1 },
+    { "reference_julia",            bench_ref_julia,         1 },
+    { "reference_multibrot3",       bench_ref_multibrot3,    1 },
+    { "reference_multibrot4",       bench_ref_multibrot4,    1 },
+    { "reference_burning_ship",     bench_ref_burning_ship,  1 },
+    { "reference_tricorn",          bench_ref_tricorn,       1 },
+    { "build_texture_twiddle",      bench_twiddle,          16 },
+    { "build_mandelbrot_plain",     bench_build_plain,       1 },
+    { "build_mandelbrot_scalar",    bench_kernel_scalar,     1 },
+    { "build_mandelbrot_pair",      bench_kernel_pair,       1 },
+    { "build_mandelbrot_unroll2",   bench_unroll2,           1 },
+    { "build_mandelbrot_unroll4",   bench_unroll4,           1 },
+    { "build_mandelbrot_unroll8",   bench_unroll8,           1 },
+    { "build_mandelbrot_unroll16",  bench_unroll16,          1 },
+    { "build_mandelbrot_adaptive",  bench_build_adaptive,    1 },
+    { "build_mandelbrot_uniform4x", bench_build_uniform4x,   1 },
+    { "apply_matrix_c",             bench_apply_matrix,   1000 },
+    { "transform_coords_c",         bench_transform_coords, 1000 },
+    { "sq_cpy_sink_2k",             bench_sq_cpy,          100 },
+    { "palette_init",               bench_palette_init,    100 },
+    { "palette_update",             bench_palette_update,  100 },
+    { "frame_build",                bench_frame,          1000 },
+    { "scene64_unsorted",           bench_scene_unsorted,   20 },
+    { "scene64_sorted",             bench_scene_sorted,     20 },
+    { "scene64_strips",             bench_scene_strips,     20 },
+};
+
+#define NUM_BENCHES (sizeof(benches) / sizeof(bench))
+
+typedef struct
+{
+    double median, p95;
+    int iterations;
+} result;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static result run(const bench *b)
+{
+    static double samples[MAX_SAMPLES];
+    double start;
+    result r;
+    int n = 0;
+
+    b->fn();
+
+    start = now();
+    while(n < MAX_SAMPLES && (n < MIN_SAMPLES || now() - start < MIN_TIME))
+    {
+        double t0 = now();
+
+        for(int k = 0; k < b->batch; k++)
+            b->fn();
+
+        samples[n++] = (now() - t0) * 1e9 / b->batch;
+    }
+
+    qsort(samples, n, sizeof(double), cmp_double);
+    r.median = samples[n / 2];
+    r.p95 = samples[(n * 95 + 99) / 100 - 1];
+    r.iterations = n;
+    return r;
+}
+
+/* Find "median_ns" of the named record in a file written by this tool */
+static int baseline_median(const char *json, const char *name, double *median)
+{
+    char key[128];
+    const char *p;
+
+    snprintf(key, sizeof(key), "\"name\": \"%s\"", name);
+    p = strstr(json, key);
+    if(!p || !(p = strstr(p, "\"median_ns\":")))
+        return 0;
+
+    *median = strtod(p + strlen("\"median_ns\":"), 0);
+    return 1;
+}
+
+static char *load_text(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char *text;
+    long n;
+
+    if(!f)
+        return 0;
+
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    text = calloc(n + 1, 1);
+    if(fread(text, 1, n, f) != (size_t)n) {
+        free(text);
+        text = 0;
+    }
+    fclose(f);
+    return text;
+}
+
+/*
+ Checks
+ */
+
+static uint8_t level_ref[256 << LOD_MAX_LEVEL][256 << LOD_MAX_LEVEL];
+static uint8_t level_out[256 << LOD_MAX_LEVEL][256 << LOD_MAX_LEVEL];
+
+static void build_level(uint8_t (*out)[256 << LOD_MAX_LEVEL], int size, int level, int formula)
+{
+    for(int i0 = 0; i0 < size; i0 += FRACTAL_BLOCK)
+        for(int j0 = 0; j0 < size; j0 += FRACTAL_BLOCK) {
+            fractal_compute_block(i0, j0, level, formula);
+            for(int li = 0; li < FRACTAL_BLOCK; li++)
+                memcpy(&out[i0 + li][j0], fractal_block[li], FRACTAL_BLOCK);
+        }
+}
+
+/* Unrefined counts of every kernel, and of FRACTAL_AUTO's pick per
+   block, against the scalar kernel's; formulas past Julia don't look at
+   fractal_kernel, they are built once per level */
+static int check_kernels()
+{
+    int fail = 0;
+
+    fractal_refine = 0;
+
+    for(int f = 0; f < FRACTAL_FORMULAS; f++)
+        for(int level = LOD_MIN_LEVEL; level <= LOD_MAX_LEVEL; level++)
+        {
+            int size = level >= 0 ? 256 << level : 256 >> -level;
+
+            fractal_kernel = 0;
+            build_level(level_ref, size, level, f);
+
+            if(level == 0)
+                for(int i = 0; i < 256 * 256; i++)
+                    if(level_ref[i / 256][i % 256] != compute_texture(i / 256, i % 256, f)) {
+                        fprintf(stderr, "FAIL: %s: texel (%d, %d) of the scalar kernel differs from compute_texture()\n",
+                                fractal_formula_names[f], i / 256, i % 256);
+                        fail = 1;
+                        break;
+                    }
+
+            for(int k = 1; f <= FRACTAL_JULIA && k <= FRACTAL_KERNELS; k++)
+            {
+                fractal_kernel = k < FRACTAL_KERNELS ? k : FRACTAL_AUTO;
+                build_level(level_out, size, level, f);
+
+                for(int i = 0; i < size; i++)
+                    if(memcmp(level_out[i], level_ref[i], size)) {
+                        fprintf(stderr, "FAIL: %s, level %d: row %d of the %s kernel differs from the scalar one\n",
+                                fractal_formula_names[f], level, i, k < FRACTAL_KERNELS ? fractal_kernel_names[k] : "auto");
+                        fail = 1;
+                        break;
+                    }
+            }
+        }
+
+    fractal_kernel = FRACTAL_AUTO;
+    fractal_refine = 4;
+    return fail;
+}
+
+
+
+int main(int argc, char **argv)
+{
+    const char *out_path = 0, *base_path = 0;
+    double threshold = 0.15;
+    result results[NUM_BENCHES];
+    char *baseline = 0;
+    FILE *out = stdout;
+    int fail = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-o") && i + 1 < argc)
+            out_path = argv[++i];
+        else if(!strcmp(argv[i], "-b") && i + 1 < argc)
+            base_path = argv[++i];
+        else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+            threshold = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [-o out.json] [-b baseline.json] [-t threshold]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(base_path && !(baseline = load_text(base_path))) {
+        perror(base_path);
+        return 1;
+    }
+
+    fractal_init();
+    pal_init();
+    vram_init();
+    atlas_init();
+    for(int i=0; i<256; i++)
+        for(int j=0; j<256; j++)
+            counts[i][j] = compute_texture(i, j, 0);
+
+    for(int f = 0; f < FRACTAL_FORMULAS; f++)
+        for(int i=0; i<256; i++)
+            for(int j=0; j<256; j++)
+                if(compute_texture(i, j, f) != references[f](i, j)) {
+                    fprintf(stderr, "%s: texel (%d, %d) differs from the reference\n", fractal_formula_names[f], i, j);
+                    return 1;
+                }
+
+    if(check_kernels())
+        return 1;
+
+    draw_send = send_sink;
+    for(unsigned i = 0; i < NUM_BENCHES; i++)
+        results[i] = run(&benches[i]);
+
+    /* Unsorted strips, sorted strips, sorted with sprites, all at frame
+       30, where neighbouring cubes overlap */
+    for(int mode = 0; mode < 3; mode++) {
+        static const char *modes[] = { "unsorted", "sorted", "sorted, sprites" };
+
+        frame = 30;
+        draw_sorted = mode > 0;
+        draw_sprites = mode > 1;
+        draw_scene();
+        fprintf(stderr, "%d cubes, %s: %u global parameters, %u sprites, %u bytes per frame\n", SCENE_CUBES,
+                modes[mode], (unsigned)draw_headers, (unsigned)draw_sprite_quads, (unsigned)draw_bytes + 32);
+    }
+
+    for(int julia = 0; julia < 2; julia++) {
+        fractal_refined = 0;
+        fractal_build(texture, julia);
+        fprintf(stderr, "adaptive supersampling, %s: %.2f%% of texels refined\n",
+                julia ? "julia" : "mandelbrot", 100.0 * fractal_refined / (256*256));
+
+        fprintf(stderr, "kernel per block, %s:\n", julia ? "julia" : "mandelbrot");
+        for(int a = 0; a < 256 / FRACTAL_BLOCK; a++) {
+            fprintf(stderr, "  ");
+            for(int b = 0; b < 256 / FRACTAL_BLOCK; b++)
+                fprintf(stderr, " %-6s", fractal_kernel_names[fractal_choice[a][b]]);
+            fprintf(stderr, "\n");
+        }
+    }
+
+    if(out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"benchmarks\": [\n");
+    for(unsigned i = 0; i < NUM_BENCHES; i++)
+        fprintf(out, "    { \"name\": \"%s\", \"median_ns\": %.1f, \"p95_ns\": %.1f, \"iterations\": %d }%s\n",
+                benches[i].name, results[i].median, results[i].p95, results[i].iterations,
+                i + 1 < NUM_BENCHES ? "," : "");
+    fprintf(out, "  ]\n}\n");
+
+    if(out != stdout)
+        fclose(out);
+
+    for(unsigned i = 0; baseline && i < NUM_BENCHES; i++)
+    {
+        double base;
+
+        if(!baseline_median(baseline, benches[i].name, &base))
+            continue;
+
+        if(results[i].median > base * (1.0 + threshold)) {
+            fprintf(stderr, "REGRESSION %s: %.1f ns, baseline %.1f ns (+%.1f%%)\n",
+                    benches[i].name, results[i].median, base, 100.0 * (results[i].median / base - 1.0));
+            fail = 1;
+        }
+    }
+
+    return fail;
+}
@@ -0,0 +1,106 @@
+/*
+  bussim - count VRAM bus transactions of the texture build
+
+    bussim [-j]
+
+  Builds the Mandelbrot texture (-j: Julia) twice: the old way, with
+  fractal_store_block() writing each pair of texels to VRAM as its own
+  16-bit store, and through fractal_build(), which stages each block in
+  cached RAM and sends it in 32 byte bursts. Reports the bus writes, the
+  bytes per write and how often consecutive writes leave the current 32
+  byte line, and checks that both paths produce the same texture.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "fractal.h"
+
+#define SIZE (256*256)
+
+typedef struct
+{
+    unsigned long writes;
+    unsigned long bytes;
+    unsigned long line_changes;
+    unsigned long last_line;
+} bus;
+
+static uint16_t old_tex[SIZE/2] __attribute__((aligned(32)));
+static uint16_t new_tex[SIZE/2] __attribute__((aligned(32)));
+static bus old_bus, new_bus;
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bus_write(bus *b, unsigned long offset, int n)
+{
+    unsigned long line = offset >> 5;
+
+    if(b->writes == 0 || line != b->last_line)
+        b->line_changes++;
+
+    b->writes++;
+    b->bytes += n;
+    b->last_line = line;
+}
+
+/* fractal_upload() that copies and counts one burst per call */
+static void *counting_upload(void *dest, const void *src, int n)
+{
+    for(int k = 0; k < n; k += 32)
+        bus_write(&new_bus, (uint8_t*)dest + k - (uint8_t*)new_tex, 32);
+
+    return memcpy(dest, src, n);
+}
+
+/* The store order of fractal_store_block(), one bus write per store */
+static void count_old_block(int i0, int j0)
+{
+    for(int li = 0; li < FRACTAL_BLOCK; li++)
+        for(int lj = 0; lj < FRACTAL_BLOCK; lj += 2)
+            bus_write(&old_bus, 2 * (twiddletab[i0+li] | twiddletab[j0+lj] >> 1), 2);
+}
+
+static void report(const char *name, const bus *b, double ms)
+{
+    printf("%-8s %8lu writes %8lu bytes %5.1f bytes/write %8lu line changes %7.2f ms\n",
+           name, b->writes, b->bytes, (double)b->bytes / b->writes, b->line_changes, ms);
+}
+
+int main(int argc, char **argv)
+{
+    int julia = argc > 1 && !strcmp(argv[1], "-j");
+    double t0, t1, t2;
+
+    fractal_init();
+
+    t0 = now();
+    for(int i0 = 0; i0 < 256; i0 += FRACTAL_BLOCK)
+        for(int j0 = 0; j0 < 256; j0 += FRACTAL_BLOCK)
+        {
+            fractal_compute_block(i0, j0, 0, julia);
+            fractal_store_block(old_tex, i0, j0);
+            count_old_block(i0, j0);
+        }
+    t1 = now();
+
+    fractal_upload = counting_upload;
+    fractal_build(new_tex, julia);
+    t2 = now();
+
+    report("direct", &old_bus, (t1 - t0) * 1e3);
+    report("staged", &new_bus, (t2 - t1) * 1e3);
+    printf("%.1fx fewer bus writes\n", (double)old_bus.writes / new_bus.writes);
+
+    if(memcmp(old_tex, new_tex, sizeof(old_tex))) {
+        fprintf(stderr, "staged texture differs from direct stores\n");
+        return 1;
+    }
+
+    return 0;
+}
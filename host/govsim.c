@@ -0,0 +1,276 @@
+/*
+  govsim - replay frame costs through the frame time governor
+
+    govsim [-v] [-l] [trace ...]
+
+  Feeds src/gov.c the frame costs of a trace, rescaled each frame by the
+  knobs the governor has set, and compares with running the same trace
+  at full quality. A trace is one frame per line at full quality, in
+  microseconds, as host/headless -o records main()'s frames:
+
+    cpu wait jobs
+
+  cpu is the time to the end of submission, wait the time from there to
+  TA done, jobs the background work run that frame. Without a trace
+  host/gov.trace, 600 frames of host/headless, is replayed, then the
+  built-in cases, each on its own:
+
+    jobs   light, then CPU heavy with jobs ready: the slice has to give
+    ta     light, then a TA wait no knob shortens
+    lod    jobs as the LOD build's levels, where the LOD bias helps
+
+  The model follows main(). A frame takes cpu + max(wait, jobs run),
+  and jobs run within the slice. In the default build refine_job() is
+  the only job: it is done with its 64 * 2 steps within the trace, and
+  runs again only when the governor changes refine, then as a new pass
+  of REFINE_STEPS steps with the new samples, restarted if refine
+  changes before it's through. -l (the lod case) is the LOD build
+  instead: no refine_job(), the trace's jobs are levels being built,
+  and cost a quarter per level of LOD bias, and less with fewer
+  refinement samples as a refine_job() step does.
+
+  Prints each change of the knobs (-v: every frame) and the frames over
+  budget both ways, and exits 1 if a governed run doesn't end at full
+  quality, or misses more than 2% of its frames where the knobs can
+  help, or more than at full quality where they can't (ta).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gov.h"
+
+#define BUDGET   16667      /* us, 60 Hz */
+#define MAX_SLICE 4000
+#define MAX_REFINE 4
+#define MAX_LOD_BIAS 2
+#define MAX_FRAMES 100000
+
+/* refine_job(): 64 blocks of 2 formulas. A step at refine 4 is the 66
+   ms of jobs at the start of host/gov.trace over its 128 steps, and
+   refinement samples are 62% of a Mandelbrot texture's iterations
+   (host/heatmap) */
+#define REFINE_STEPS 128
+#define REFINE_STEP  516.0
+#define REFINE_SHARE 0.62
+
+typedef struct
+{
+    double cpu, wait, jobs;
+} frame_cost;
+
+typedef struct
+{
+    const char *name;
+    int lod;            /* LOD build */
+    int helps;          /* the knobs can keep it under budget */
+    struct { int frames; double cpu, wait, jobs; } phases[4];
+} scenario;
+
+static const scenario cases[] = {
+    { "jobs", 0, 1, {
+        {  600,  4000,  3000, 2000 },
+        {  600, 13000,  1500, 8000 },
+        {  300, 14000,  1500, 8000 },
+        { 2400,  4000,  3000, 2000 },
+    } },
+    { "ta", 0, 0, {
+        {  600,  4000,  3000, 2000 },
+        {  300,  6000, 12000, 2000 },
+        { 2400,  4000,  3000, 2000 },
+    } },
+    { "lod", 1, 1, {
+        {  600,  4000,  3000, 2000 },
+        {  600, 13000,  1000, 3000 },
+        {  300, 14500,  1000, 3000 },
+        { 2400,  4000,  3000, 2000 },
+    } },
+};
+
+#define CASES (int)(sizeof(cases) / sizeof(cases[0]))
+
+static frame_cost trace[MAX_FRAMES];
+static uint32_t seed = 1;
+static int verbose;
+
+/* refine_job()'s pass: step, samples it latched, samples of the textures */
+static int step, pass, done;
+
+static double noise()
+{
+    seed = seed * 1103515245 + 12345;
+    return 0.9 + 0.2 * ((seed >> 16) & 0x7fff) / 0x7fff;
+}
+
+static int build(const scenario *s)
+{
+    int n = 0;
+
+    for(int p = 0; p < 4; p++)
+        for(int f = 0; f < s->phases[p].frames; f++, n++) {
+            trace[n].cpu = s->phases[p].cpu * noise();
+            trace[n].wait = s->phases[p].wait * noise();
+            trace[n].jobs = s->phases[p].jobs * noise();
+        }
+
+    return n;
+}
+
+static int load(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    int n = 0;
+
+    if(!f) {
+        perror(path);
+        exit(1);
+    }
+
+    while(n < MAX_FRAMES && fscanf(f, "%lf %lf %lf", &trace[n].cpu, &trace[n].wait, &trace[n].jobs) == 3)
+        n++;
+
+    fclose(f);
+    return n;
+}
+
+/* Time of a refinement step with the given samples */
+static double refine_cost(int refine)
+{
+    return REFINE_STEP * (1 - REFINE_SHARE + REFINE_SHARE * refine / MAX_REFINE);
+}
+
+/* Cost of frame f with the knobs as they are */
+static double play(const frame_cost *c, int lod, uint32_t *cpu, uint32_t *wait)
+{
+    double jobs = c->jobs, run;
+
+    if(lod)
+        jobs *= refine_cost(gov.refine) / refine_cost(MAX_REFINE) / (1 << 2*gov.lod_bias);
+
+    run = jobs < gov.slice ? jobs : gov.slice;
+
+    /* refine_job(): the first step of a frame runs whatever is left */
+    if(!lod)
+    {
+        if(step && gov.refine != pass)
+            step = 0;
+
+        if(step || gov.refine != done)
+        {
+            if(!step)
+                pass = gov.refine;
+
+            do {
+                run += refine_cost(pass);
+                if(++step == REFINE_STEPS) {
+                    step = 0;
+                    done = pass;
+                    break;
+                }
+            } while(run < gov.slice);
+        }
+    }
+
+    *cpu = c->cpu;
+    *wait = c->wait;
+
+    return *cpu + (*wait > run ? *wait : run);
+}
+
+/* The trace at full quality, then governed; returns 1 if it fails */
+static int run(const char *name, int frames, int lod, int helps)
+{
+    gov_knobs last;
+    gov_limits limits = {
+        .budget        = BUDGET,
+        .min_slice     = MAX_SLICE / 8,
+        .max_slice     = MAX_SLICE,
+        .max_refine    = MAX_REFINE,
+        .max_lod_bias  = lod ? MAX_LOD_BIAS : 0,
+    };
+    int fixed_over = 0, fail = 0;
+
+    /* The trace includes the first refinement pass */
+    gov_init(&limits);
+    step = 0;
+    pass = done = MAX_REFINE;
+    for(int k = 0; k < frames; k++) {
+        uint32_t cpu, wait;
+
+        fixed_over += play(&trace[k], lod, &cpu, &wait) > BUDGET;
+    }
+
+    gov_init(&limits);
+    step = 0;
+    pass = done = MAX_REFINE;
+    last = gov;
+    for(int k = 0; k < frames; k++)
+    {
+        uint32_t cpu, wait, total = play(&trace[k], lod, &cpu, &wait);
+
+        gov_update(cpu, wait, total);
+
+        if(verbose || memcmp(&gov, &last, sizeof(gov)))
+            printf("frame %5d: %5u us, average %5u, slice %4u refine %d lod bias %d\n",
+                   k, total, gov_info.average, gov.slice, gov.refine, gov.lod_bias);
+        last = gov;
+    }
+
+    printf("%s: %d frames, budget %d us: %d over at full quality, %u over governed (%u degrades, %u restores)\n",
+           name, frames, BUDGET, fixed_over, gov_info.over, gov_info.degrades, gov_info.restores);
+
+    if(helps && gov_info.over * 50 > (uint32_t)frames) {
+        printf("FAIL: %s: more than 2%% of frames over budget\n", name);
+        fail = 1;
+    }
+    if(!helps && gov_info.over > (uint32_t)fixed_over) {
+        printf("FAIL: %s: more frames over budget than at full quality\n", name);
+        fail = 1;
+    }
+    if(gov.slice != MAX_SLICE || gov.refine != MAX_REFINE || gov.lod_bias) {
+        printf("FAIL: %s: didn't return to full quality\n", name);
+        fail = 1;
+    }
+
+    return fail;
+}
+
+int main(int argc, char **argv)
+{
+    int lod = 0, traces = 0, fail = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else if(!strcmp(argv[i], "-l"))
+            lod = 1;
+        else if(argv[i][0] != '-')
+            traces++;
+        else {
+            fprintf(stderr, "usage: %s [-v] [-l] [trace ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for(int i = 1; i < argc; i++)
+        if(argv[i][0] != '-') {
+            int frames = load(argv[i]);
+
+            if(!frames) {
+                fprintf(stderr, "%s: no frames\n", argv[i]);
+                return 1;
+            }
+            fail |= run(argv[i], frames, lod, 1);
+        }
+
+    if(traces)
+        return fail;
+
+    fail |= run("host/gov.trace", load("host/gov.trace"), 0, 1);
+
+    for(int c = 0; c < CASES; c++)
+        fail |= run(cases[c].name, build(&cases[c]), cases[c].lod, cases[c].helps);
+
+    return fail;
+}
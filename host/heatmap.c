@@ -0,0 +1,232 @@
+/*
+  heatmap - where the texture build spends its iterations
+
+    heatmap [-f formula] [-r refine] [prefix]
+
+  Builds one formula's texture (default mandelbrot, see fractal.h) with
+  src/fractal.c compiled with -DFRACTAL_STATS and writes
+
+    prefix.ppm        iterations per 8x8 cell, 256x256, row i column j,
+                      black through red and yellow to white at the
+                      costliest cell
+    prefix_hist.csv   texels by iterations of their first sample, 256
+                      meaning no early out
+    prefix_cells.csv  the totals of every 8x8 cell
+
+  prefix defaults to the formula name. Prints the iterations spent,
+  their split between texels that bailed out, texels that ran to the
+  limit and refinement samples, the costliest cells, and for Mandelbrot
+  and Julia the time per iteration of each kernel on this texture.
+  -r sets fractal_refine (default 4).
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fractal.h"
+#include "timer.h"
+
+#define CELLS (256 / FRACTAL_STATS_CELL)
+#define TOP   5
+
+static uint16_t texture[256*256/2];
+
+static FILE *create(const char *prefix, const char *suffix)
+{
+    static char path[512];
+    FILE *f;
+
+    snprintf(path, sizeof(path), "%s%s", prefix, suffix);
+    if(!(f = fopen(path, "w"))) {
+        perror(path);
+        exit(1);
+    }
+
+    return f;
+}
+
+/* 0..1 to black, red, yellow, white */
+static void ramp(double t, uint8_t *rgb)
+{
+    double v = t * 3;
+
+    for(int k = 0; k < 3; k++) {
+        double c = v - k;
+        rgb[k] = c <= 0 ? 0 : c >= 1 ? 255 : (uint8_t)(c * 255 + 0.5);
+    }
+}
+
+static void write_heatmap(const char *prefix, uint32_t most)
+{
+    FILE *f = create(prefix, ".ppm");
+
+    fprintf(f, "P6\n256 256\n255\n");
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++) {
+            uint8_t rgb[3];
+
+            ramp((double)fractal_cells[i / FRACTAL_STATS_CELL][j / FRACTAL_STATS_CELL].iterations / most, rgb);
+            fwrite(rgb, 1, 3, f);
+        }
+
+    fclose(f);
+}
+
+/* The first sample is exactly compute_texture(), refined texels'
+   iteration totals include the rest */
+static void write_histogram(const char *prefix, int formula)
+{
+    static uint32_t hist[257];
+    FILE *f = create(prefix, "_hist.csv");
+
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            hist[compute_texture(i, j, formula) + 1]++;
+
+    fprintf(f, "iterations,texels\n");
+    for(int n = 1; n <= 256; n++)
+        fprintf(f, "%d,%u\n", n, hist[n]);
+
+    fclose(f);
+}
+
+static void write_cells(const char *prefix)
+{
+    FILE *f = create(prefix, "_cells.csv");
+
+    fprintf(f, "i,j,iterations,bailouts,maxiters,refined\n");
+    for(int a = 0; a < CELLS; a++)
+        for(int b = 0; b < CELLS; b++) {
+            const fractal_cell *c = &fractal_cells[a][b];
+
+            fprintf(f, "%d,%d,%u,%u,%u,%u\n", a * FRACTAL_STATS_CELL, b * FRACTAL_STATS_CELL,
+                    c->iterations, c->bailouts, c->maxiters, c->refined);
+        }
+
+    fclose(f);
+}
+
+static void report_kernels(int formula, uint64_t iterations)
+{
+    int saved = fractal_kernel, refine = fractal_refine;
+
+    /* Kernel speed only, refinement goes through compute_sample() */
+    fractal_refine = 0;
+    for(int k = 0; k < FRACTAL_KERNELS; k++)
+    {
+        uint32_t best = 0xFFFFFFFF;
+
+        fractal_kernel = k;
+        for(int run = 0; run < 3; run++) {
+            uint32_t t = timer_ticks();
+
+            fractal_build(texture, formula);
+            t = timer_ticks() - t;
+            if(t < best)
+                best = t;
+        }
+
+        printf("  %-8s %7.3f ms %6.2f ns/iteration\n", fractal_kernel_names[k],
+               best * 1e3 / TIMER_HZ, best * 1e9 / TIMER_HZ / iterations);
+    }
+
+    fractal_kernel = saved;
+    fractal_refine = refine;
+}
+
+int main(int argc, char **argv)
+{
+    const char *prefix = 0;
+    int formula = FRACTAL_MANDELBROT;
+    uint64_t total = 0, first = 0, capped = 0;
+    uint32_t bailouts = 0, maxiters = 0, refined = 0, most = 0;
+    int top[TOP], ti = 0, tj = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-f") && i + 1 < argc) {
+            for(formula = 0; formula < FRACTAL_FORMULAS; formula++)
+                if(!strcmp(argv[i+1], fractal_formula_names[formula]))
+                    break;
+            i++;
+        }
+        else if(!strcmp(argv[i], "-r") && i + 1 < argc)
+            fractal_refine = atoi(argv[++i]);
+        else if(argv[i][0] != '-' && !prefix)
+            prefix = argv[i];
+        else
+            formula = FRACTAL_FORMULAS;
+    }
+
+    if(formula == FRACTAL_FORMULAS || fractal_refine < 0) {
+        fprintf(stderr, "usage: %s [-f formula] [-r refine] [prefix]\n", argv[0]);
+        return 1;
+    }
+
+    if(!prefix)
+        prefix = fractal_formula_names[formula];
+
+    fractal_init();
+    fractal_stats_clear();
+    fractal_build(texture, formula);
+
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++) {
+            uint32_t n = compute_texture(i, j, formula) + 1;
+
+            first += n;
+            if(fractal_texel_iterations[i][j] > fractal_texel_iterations[ti][tj])
+                ti = i, tj = j;
+            if(fractal_texel_exit[i][j] == FRACTAL_EXIT_MAXITER)
+                capped += n;
+        }
+
+    for(int a = 0; a < CELLS; a++)
+        for(int b = 0; b < CELLS; b++) {
+            const fractal_cell *c = &fractal_cells[a][b];
+
+            total += c->iterations;
+            bailouts += c->bailouts;
+            maxiters += c->maxiters;
+            refined += c->refined;
+            if(c->iterations > most)
+                most = c->iterations;
+        }
+
+    printf("%s: %llu iterations, %.1f per texel\n", fractal_formula_names[formula],
+           (unsigned long long)total, (double)total / (256*256));
+    printf("  bailout  %6u texels %5.1f%% of iterations\n", bailouts, 100.0 * (first - capped) / total);
+    printf("  maxiter  %6u texels %5.1f%% of iterations\n", maxiters, 100.0 * capped / total);
+    printf("  refined  %6u texels %5.1f%% of iterations\n", refined, 100.0 * (total - first) / total);
+
+    printf("  texel (%3d, %3d) %7u iterations\n", ti, tj, fractal_texel_iterations[ti][tj]);
+
+    /* Costliest cells, a few picks from 1024 */
+    for(int t = 0; t < TOP; t++)
+    {
+        top[t] = -1;
+        for(int c = 0; c < CELLS*CELLS; c++)
+        {
+            int taken = 0;
+
+            for(int u = 0; u < t; u++)
+                taken |= top[u] == c;
+
+            if(!taken && (top[t] < 0 || fractal_cells[c / CELLS][c % CELLS].iterations >
+                                        fractal_cells[top[t] / CELLS][top[t] % CELLS].iterations))
+                top[t] = c;
+        }
+
+        printf("  cell (%3d, %3d) %7u iterations\n", top[t] / CELLS * FRACTAL_STATS_CELL,
+               top[t] % CELLS * FRACTAL_STATS_CELL, fractal_cells[top[t] / CELLS][top[t] % CELLS].iterations);
+    }
+
+    write_heatmap(prefix, most);
+    write_histogram(prefix, formula);
+    write_cells(prefix);
+
+    if(formula <= FRACTAL_JULIA)
+        report_kernels(formula, first);
+
+    return 0;
+}
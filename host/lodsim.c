@@ -0,0 +1,186 @@
+/*
+  lodsim - texture level of detail against fixed resolution textures
+
+    lodsim [-n frames] [-a kbytes] [-v]
+
+  Flies a grid of 16 spinning cubes, faces Mandelbrot and Julia like
+  main(), from far away up close and back over the given frames
+  (default 600) and draws every face facing the screen through
+  src/lod.c, with its levels in plain memory and up to 4 ms of
+  lod_job() a frame, in an arena of LOD_ARENA bytes or -a kbytes. Prints
+  the most VRAM the levels held at once, how many were freed after
+  LOD_KEEP frames unused or to make room, and the time spent computing
+  them, against building both formulas once at a fixed 256x256 (the
+  atlas main() uses) and at the finest level any face wanted. Also prints the part of the level time spent before the first
+  frame could be drawn, and how many faces were drawn coarser than they
+  wanted while levels were still being computed.
+  -v prints one line per frame.
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fractal.h"
+#include "lod.h"
+#include "sched.h"
+#include "timer.h"
+
+#define CUBES  16
+#define BUDGET (TIMER_HZ / 250)
+
+/* Corners and faces as main() has them */
+static const float coords[8][3] = {
+    { -1, -1, -1 }, {  1, -1, -1 }, { -1,  1, -1 }, {  1,  1, -1 },
+    { -1, -1,  1 }, {  1, -1,  1 }, { -1,  1,  1 }, {  1,  1,  1 },
+};
+
+static const int faces[6][4] = {
+    { 0, 1, 2, 3 }, { 1, 5, 3, 7 }, { 4, 5, 0, 1 },
+    { 5, 4, 7, 6 }, { 4, 0, 6, 2 }, { 2, 3, 6, 7 },
+};
+
+static const int face_formula[6] = {
+    FRACTAL_MANDELBROT, FRACTAL_MANDELBROT, FRACTAL_MANDELBROT,
+    FRACTAL_JULIA,      FRACTAL_JULIA,      FRACTAL_JULIA,
+};
+
+static uint16_t *host_alloc(uint32_t bytes)
+{
+    return malloc(bytes);
+}
+
+/* Cube c's corners on screen at frame f of n, with main()'s 640x480
+   projection. The grid is 4x4, 6 apart, and comes from 80 units away
+   to 3 and goes back */
+static void project(int c, int f, int n, float (*out)[3])
+{
+    double t = (double)f / n, away = 3 + 77 * fabs(1 - 2 * t);
+    double a = f * 0.02 + c, b = f * 0.013 + c * 0.5;
+    double cx = (c % 4 - 1.5) * 6, cy = (c / 4 - 1.5) * 6, cz = away + (c % 3) * 4;
+
+    for(int k = 0; k < 8; k++)
+    {
+        double x = coords[k][0], y = coords[k][1], z = coords[k][2], u;
+
+        u = x * cos(a) + z * sin(a);
+        z = -x * sin(a) + z * cos(a);
+        x = u;
+        u = y * cos(b) - z * sin(b);
+        z = y * sin(b) + z * cos(b);
+        y = u;
+
+        x += cx;
+        y += cy;
+        z += cz;
+
+        out[k][0] = 320 + 240 * 1.73 * x / z;
+        out[k][1] = 240 + 240 * 1.73 * y / z;
+        out[k][2] = 1 / z;
+    }
+}
+
+/* Both formulas at one level, block by block as lod.c does; returns ticks */
+static uint32_t fixed(int level, uint16_t *dst)
+{
+    int size = 256 << level;
+    uint32_t t = timer_ticks();
+
+    for(int f = 0; f < 2; f++)
+        for(int i0 = 0; i0 < size; i0 += FRACTAL_BLOCK)
+            for(int j0 = 0; j0 < size; j0 += FRACTAL_BLOCK) {
+                fractal_compute_block(i0, j0, level, f);
+                fractal_upload_block(dst, i0, j0);
+            }
+
+    return timer_ticks() - t;
+}
+
+int main(int argc, char **argv)
+{
+    static uint16_t texture[1024*1024/2];
+    int frames = 600, verbose = 0;
+    uint32_t arena = LOD_ARENA;
+    uint32_t fixed256, finest, bound = 0, first = 0;
+    int top = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-a") && i + 1 < argc)
+            arena = atoi(argv[++i]) * 1024;
+        else if(!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else
+            frames = 0, i = argc;
+    }
+
+    if(frames < 1 || !arena || arena > LOD_ARENA) {
+        fprintf(stderr, "usage: %s [-n frames] [-a kbytes] [-v]\n", argv[0]);
+        return 1;
+    }
+
+    fractal_init();
+    fixed256 = fixed(0, texture);
+
+    lod_alloc = host_alloc;
+    lod_init(arena);
+
+    for(int f = 0; f < frames; f++)
+    {
+        uint32_t start, frame_bound = 0, drawn = 0;
+
+        lod_frame_begin();
+        for(int c = 0; c < CUBES; c++)
+        {
+            float p[8][3];
+
+            project(c, f, frames, p);
+            for(int k = 0; k < 6; k++) {
+                const lod_level *l = lod_face(face_formula[k], p[faces[k][0]], p[faces[k][1]],
+                                              p[faces[k][2]], p[faces[k][3]]);
+                if(l) {
+                    frame_bound += l->size;
+                    drawn++;
+                }
+            }
+        }
+
+        if(f == 0)
+            first = lod_info.ticks;
+
+        start = timer_ticks();
+        while(timer_ticks() - start < BUDGET && lod_job(0) == SCHED_MORE)
+            ;
+
+        bound += frame_bound / drawn;
+        if(verbose)
+            printf("frame %4d: %4u texels a side on average, %7u bytes of levels, %7.2f ms computing\n",
+                   f, frame_bound / drawn, lod_info.vram, lod_info.ticks * 1e3 / TIMER_HZ);
+    }
+
+    printf("levels wanted (texels a side):");
+    for(int k = 0; k < LOD_LEVELS; k++)
+        for(int f = 0; f < 2; f++)
+            if(lod_levels[f][k].wanted) {
+                printf(" %s %d%s", fractal_formula_names[f], lod_levels[f][k].size,
+                       !lod_levels[f][k].texels ? " (not resident)" : lod_ready(&lod_levels[f][k]) ? "" : " (partial)");
+                top = k;
+            }
+    printf("\n");
+
+    finest = fixed(LOD_MIN_LEVEL + top, texture);
+
+    printf("lod:         %8u bytes of VRAM at most, %8.2f ms computing, %u blocks\n",
+           lod_info.peak, lod_info.ticks * 1e3 / TIMER_HZ, lod_info.blocks);
+    printf("             %8u bytes at the end, %u levels freed\n", lod_info.vram, lod_info.freed);
+    printf("             %8.2f ms of it before the first frame\n", first * 1e3 / TIMER_HZ);
+    printf("fixed  256:  %8u bytes of VRAM, %8.2f ms computing\n", 2*256*256, fixed256 * 1e3 / TIMER_HZ);
+    printf("fixed %4d:  %8u bytes of VRAM, %8.2f ms computing\n", lod_levels[0][top].size,
+           2 * lod_levels[0][top].size * lod_levels[0][top].size, finest * 1e3 / TIMER_HZ);
+    printf("%d frames, %u faces: %.1f%% drawn coarser than wanted, %.0f texels a side on average\n",
+           frames, lod_info.faces, 100.0 * lod_info.coarse / lod_info.faces, (double)bound / frames);
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+  schedsim - run the job scheduler against a simulated clock
+
+    schedsim [-n frames] [-b budget] [-v]
+
+  Drives src/sched.c with a set of jobs whose steps advance a fake clock
+  by fixed or pseudo-random amounts, so every run is the same. Reports
+  each job's steps and share of the time, then checks that no frame ran
+  past its budget by more than one step and that the jobs that always
+  had work got the same time to within one step. Exits 1 if not. -v
+  prints the ticks used in each frame.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sched.h"
+
+static uint32_t now;
+static uint32_t seed = 1;
+
+static uint32_t sim_clock()
+{
+    return now;
+}
+
+static uint32_t rnd(uint32_t n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % n;
+}
+
+/* Jobs that always have more work, with different step lengths */
+static int short_job(void *arg)  { now += 100; return SCHED_MORE; }
+static int long_job(void *arg)   { now += 900; return SCHED_MORE; }
+static int random_job(void *arg) { now += 50 + rnd(1500); return SCHED_MORE; }
+
+/* A little work once a frame */
+static int frame_job(void *arg)  { now += 40; return SCHED_IDLE; }
+
+/* A fixed amount of work, like refining the textures */
+static int finite_job(void *arg)
+{
+    static int left = 400;
+
+    now += 300;
+    return --left ? SCHED_MORE : SCHED_DONE;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 1000, verbose = 0, fail = 0;
+    uint32_t budget = 5000, longest = 0, least = 0xFFFFFFFF, most = 0;
+    double total = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-b") && i + 1 < argc)
+            budget = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else {
+            fprintf(stderr, "usage: %s [-n frames] [-b budget] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    sched_clock = sim_clock;
+    sched_add("frame", frame_job, 0);
+    sched_add("short", short_job, 0);
+    sched_add("long", long_job, 0);
+    sched_add("random", random_job, 0);
+    sched_add("finite", finite_job, 0);
+
+    for(int f = 0; f < frames; f++)
+    {
+        sched_frame(budget);
+        while(sched_run())
+            ;
+
+        if(verbose)
+            printf("frame %d: %u ticks\n", f, sched_info.used);
+    }
+    sched_frame(budget);
+
+    for(int k = 0; k < sched_job_count; k++)
+        total += sched_jobs[k].ticks;
+
+    printf("%-8s %8s %10s %7s %8s\n", "job", "steps", "ticks", "share", "longest");
+    for(int k = 0; k < sched_job_count; k++)
+    {
+        const sched_job *j = &sched_jobs[k];
+
+        printf("%-8s %8u %10u %6.1f%% %8u\n", j->name, j->steps, j->ticks,
+               100.0 * j->ticks / total, j->longest);
+
+        if(j->longest > longest)
+            longest = j->longest;
+
+        /* The jobs that never ran out of work */
+        if(j->step != frame_job) {
+            if(j->ticks < least)
+                least = j->ticks;
+            if(j->ticks > most)
+                most = j->ticks;
+        }
+    }
+
+    printf("%u frames, budget %u, worst frame %u, %u over budget\n",
+           frames, budget, sched_info.worst, sched_info.overruns);
+
+    if(sched_info.worst >= budget + longest) {
+        printf("FAIL: a frame ran more than one step past the budget\n");
+        fail = 1;
+    }
+    if(most - least > longest) {
+        printf("FAIL: busy jobs' time differs by %u ticks, more than one step\n", most - least);
+        fail = 1;
+    }
+
+    return fail;
+}
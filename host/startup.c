@@ -0,0 +1,129 @@
+/*
+  startup - cold and warm texture builds through the texture cache
+
+    startup [-d dir] [-r refine]
+
+  Builds the textures main() starts with, Mandelbrot and Julia at 256x256
+  (tex[0] and tex[1]), then a large atlas of the same two at 1024x1024,
+  through tool/texcache.c: once with an empty cache (cold), computing and
+  storing, then again from the files (warm). The cache goes in dir
+  (default .texcache-startup), which is emptied first. Prints both times
+  for each set, the speedup and the cache's size on disk, and exits 1 if
+  a warm texture differs from its cold build or wasn't a hit.
+  -r sets fractal_refine (default 4).
+*/
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fractal.h"
+#include "texcache.h"
+#include "timer.h"
+
+#define ATLAS_LEVEL 2
+#define MAX_BYTES   ((256 << ATLAS_LEVEL) * (256 << ATLAS_LEVEL))
+
+static const struct
+{
+    const char *name;
+    int level;
+} sets[] = {
+    { "tex[0], tex[1]", 0 },
+    { "atlas 1024x1024", ATLAS_LEVEL },
+};
+
+#define SETS (int)(sizeof(sets) / sizeof(sets[0]))
+
+static uint16_t cold[2][MAX_BYTES / 2], warm[2][MAX_BYTES / 2];
+
+/* Remove the cache's files, returns the bytes they took */
+static long sweep(const char *dir)
+{
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    long bytes = 0;
+
+    if(!d)
+        return 0;
+
+    while((e = readdir(d)))
+    {
+        char path[512];
+        struct stat st;
+
+        if(e->d_name[0] == '.')
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s", dir, e->d_name);
+        if(stat(path, &st) == 0)
+            bytes += st.st_size;
+        remove(path);
+    }
+
+    closedir(d);
+    return bytes;
+}
+
+/* Both formulas of a set, returns ticks; hits counts cache hits */
+static uint32_t build(int level, uint16_t *dst0, uint16_t *dst1, int *hits)
+{
+    uint32_t t = timer_ticks();
+
+    *hits = texcache_build(dst0, FRACTAL_MANDELBROT, level);
+    *hits += texcache_build(dst1, FRACTAL_JULIA, level);
+
+    return timer_ticks() - t;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = ".texcache-startup";
+    int fail = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-d") && i + 1 < argc)
+            dir = argv[++i];
+        else if(!strcmp(argv[i], "-r") && i + 1 < argc)
+            fractal_refine = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [-d dir] [-r refine]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    fractal_init();
+    texcache_dir = dir;
+
+    for(int s = 0; s < SETS; s++)
+    {
+        int size = 256 << sets[s].level, hits;
+        uint32_t tc, tw;
+        long disk;
+
+        sweep(dir);
+        tc = build(sets[s].level, cold[0], cold[1], &hits);
+        if(hits) {
+            printf("%s: cache in %s wasn't empty\n", sets[s].name, dir);
+            fail = 1;
+        }
+
+        tw = build(sets[s].level, warm[0], warm[1], &hits);
+        for(int f = 0; f < 2; f++)
+            if(hits != 2 || memcmp(warm[f], cold[f], size * size)) {
+                printf("%s: %s texture not restored from the cache\n", sets[s].name, fractal_formula_names[f]);
+                fail = 1;
+            }
+
+        disk = sweep(dir);
+        printf("%-16s cold %8.2f ms  warm %6.2f ms  %6.1fx  %7ld bytes on disk for %d (%.1f%%)\n",
+               sets[s].name, tc * 1e3 / TIMER_HZ, tw * 1e3 / TIMER_HZ, (double)tc / tw,
+               disk, 2 * size * size, 100.0 * disk / (2 * size * size));
+    }
+
+    rmdir(dir);
+    return fail;
+}
@@ -0,0 +1,190 @@
+/*
+  vramtest - check the VRAM arena's bookkeeping
+
+    vramtest
+
+  Runs src/vram.c through fixed allocation sequences and checks the
+  offsets and vram_report() against the layout worked out by hand:
+  alignment in each address space, VRAM_TEX64 ranges taking the same
+  bank-local bytes in both banks and never overlapping the 32-bit
+  allocations, VRAM_FAIL when a bank is full, frame scratch coming down
+  from the top of a bank and dropped by vram_frame_begin(), and the
+  used, padding, peak, free and largest free range counts. Prints each failed check and exits 1 if there is one.
+*/
+#include <stdio.h>
+
+#include "dc_locations.h"
+#include "vram.h"
+
+#define BANK_SIZE (VRAM_BANK2_BASE - VRAM_BANK1_BASE)
+
+/* Only offsets are checked, nothing is written through these */
+uint8_t hal_vram[HAL_VRAM_BYTES], hal_vram64[HAL_VRAM_BYTES];
+
+static int failed;
+
+static void check(int ok, const char *what, uint32_t got, uint32_t want)
+{
+    if(!ok) {
+        printf("FAIL: %s: got 0x%x, want 0x%x\n", what, got, want);
+        failed = 1;
+    }
+}
+
+static void expect(const char *what, uint32_t got, uint32_t want)
+{
+    check(got == want, what, got, want);
+}
+
+/* The bank-local range a 64-bit path offset touches, in 32-bit words:
+   word w of the texture is word w/2 of bank w&1 */
+static uint32_t tex64_local(uint32_t offset)
+{
+    return offset / 2;
+}
+
+static void alignment()
+{
+    vram_stats s;
+    uint32_t a, b, c;
+
+    vram_init();
+
+    a = vram_alloc(VRAM_BANK1, 6, 4, "a");
+    b = vram_alloc(VRAM_BANK1, 40, 32, "b");
+    c = vram_alloc(VRAM_BANK2, 4, 4, "c");
+
+    expect("bank 1 starts at its base", a, VRAM_BANK1_BASE);
+    expect("bank 1 rounds up to the alignment", b, VRAM_BANK1_BASE + 32);
+    expect("bank 2 starts at its base", c, VRAM_BANK2_BASE);
+
+    vram_report(&s);
+    expect("used", s.used, 6 + 40 + 4);
+    expect("padding", s.padding, 32 - 6);
+    expect("free", s.free, 2*BANK_SIZE - 72 - 4);
+    expect("regions", vram_region_count, 3);
+}
+
+static void tex64()
+{
+    vram_stats s;
+    uint32_t a, b, t, u;
+
+    vram_init();
+
+    /* Banks at different heights: the texture starts above both */
+    a = vram_alloc(VRAM_BANK1, 100, 4, "a");
+    b = vram_alloc(VRAM_BANK2, 300, 4, "b");
+    t = vram_alloc(VRAM_TEX64, 256*256, 32, "t");
+
+    check(t % 32 == 0, "texture aligned to 32", t, t & ~31);
+    expect("texture starts above both, at a 16 byte local boundary", tex64_local(t), 304);
+
+    /* Both banks now end at the same local address */
+    a = vram_alloc(VRAM_BANK1, 4, 4, "a2");
+    b = vram_alloc(VRAM_BANK2, 4, 4, "b2");
+    expect("bank 1 resumes after the texture", a, VRAM_BANK1_BASE + 304 + 256*256/2);
+    expect("bank 2 resumes after the texture", b, VRAM_BANK2_BASE + 304 + 256*256/2);
+
+    /* Odd sizes round up to a whole 8 byte granule */
+    u = vram_alloc(VRAM_TEX64, 12, 8, "u");
+    expect("second texture above both banks", tex64_local(u), 304 + 256*256/2 + 4);
+
+    vram_report(&s);
+    expect("used", s.used, 100 + 300 + 256*256 + 4 + 4 + 12);
+    expect("padding", s.padding, (304 - 100) + (304 - 300) + 0 + 0 + 4);
+    expect("used + padding + free", s.used + s.padding + s.free, 2*BANK_SIZE);
+}
+
+static void overflow()
+{
+    vram_stats before, after;
+    uint32_t a;
+
+    vram_init();
+
+    a = vram_alloc(VRAM_BANK1, BANK_SIZE - 64, 32, "most of bank 1");
+    expect("bank 1 nearly full", a, VRAM_BANK1_BASE);
+
+    vram_report(&before);
+    expect("bank 1 overflow", vram_alloc(VRAM_BANK1, 128, 4, "too big"), VRAM_FAIL);
+    expect("texture needs bank 1 too", vram_alloc(VRAM_TEX64, 256, 32, "too big"), VRAM_FAIL);
+    expect("bank 2 overflow", vram_alloc(VRAM_BANK2, BANK_SIZE + 4, 4, "too big"), VRAM_FAIL);
+    vram_report(&after);
+
+    expect("failed allocations leave used", after.used, before.used);
+    expect("failed allocations leave padding", after.padding, before.padding);
+    expect("failed allocations aren't recorded", vram_region_count, 1);
+
+    /* What is left still fits exactly */
+    expect("bank 1 remainder", vram_alloc(VRAM_BANK1, 64, 4, "rest"), VRAM_BANK1_BASE + BANK_SIZE - 64);
+    expect("bank 2 whole", vram_alloc(VRAM_BANK2, BANK_SIZE, 4, "all"), VRAM_BANK2_BASE);
+    vram_report(&after);
+    expect("free when full", after.free, 0);
+}
+
+static void scratch()
+{
+    vram_stats s;
+    uint32_t a, b, c;
+
+    vram_init();
+
+    a = vram_alloc(VRAM_BANK1, 1000, 4, "a");
+    b = vram_scratch(VRAM_BANK1, 100, 32);
+    c = vram_scratch(VRAM_BANK1, 8, 4);
+
+    expect("arena from the bottom", a, VRAM_BANK1_BASE);
+    expect("scratch from the top, aligned down", b, VRAM_BANK1_BASE + ((BANK_SIZE - 100) & ~31));
+    expect("more scratch below it", c, b - 8);
+
+    vram_report(&s);
+    expect("scratch", s.scratch, BANK_SIZE - (c - VRAM_BANK1_BASE));
+    expect("peak with scratch", s.peak, 1000 + s.scratch);
+    expect("free between the arena and the scratch", s.free, (c - VRAM_BANK1_BASE) - 1000 + BANK_SIZE);
+    expect("largest is bank 2", s.largest, BANK_SIZE);
+
+    /* Neither side grows into the other */
+    expect("arena stops at the scratch", vram_alloc(VRAM_BANK1, c - VRAM_BANK1_BASE - 1000 + 4, 4, "too big"), VRAM_FAIL);
+    expect("scratch stops at the arena", vram_scratch(VRAM_BANK1, c - VRAM_BANK1_BASE - 1000 + 4, 4), VRAM_FAIL);
+    expect("texture stops at the scratch", vram_alloc(VRAM_TEX64, 2*(c - VRAM_BANK1_BASE - 1000) + 8, 32, "too big"), VRAM_FAIL);
+    expect("scratch fills the gap exactly", vram_scratch(VRAM_BANK1, c - VRAM_BANK1_BASE - 1000, 4), VRAM_BANK1_BASE + 1000);
+
+    /* A new frame drops the scratch, the peak stays */
+    vram_frame_begin();
+    vram_report(&s);
+    expect("scratch dropped", s.scratch, 0);
+    expect("peak kept", s.peak, BANK_SIZE);
+    expect("free after the frame", s.free, 2*BANK_SIZE - 1000);
+    expect("largest after the frame", s.largest, BANK_SIZE);
+    expect("scratch starts at the top again", vram_scratch(VRAM_BANK2, 64, 32), VRAM_BANK2_BASE + BANK_SIZE - 64);
+}
+
+static void fragmentation()
+{
+    vram_stats s;
+
+    vram_init();
+
+    /* A 256x256 texture in both banks, then bank 1 runs further */
+    vram_alloc(VRAM_TEX64, 256*256, 32, "t");
+    vram_alloc(VRAM_BANK1, 3*BANK_SIZE/4 - 256*256/2, 4, "a");
+
+    vram_report(&s);
+    expect("free in both banks", s.free, BANK_SIZE/4 + BANK_SIZE - 256*256/2);
+    expect("largest is what is left of bank 2", s.largest, BANK_SIZE - 256*256/2);
+    expect("a texture needs both banks: a quarter bank at most", vram_alloc(VRAM_TEX64, BANK_SIZE/2 + 8, 32, "too big"), VRAM_FAIL);
+    check(vram_alloc(VRAM_TEX64, BANK_SIZE/2, 32, "fits") != VRAM_FAIL, "a texture of half a bank fits", 0, 0);
+}
+
+int main(int argc, char **argv)
+{
+    alignment();
+    tex64();
+    overflow();
+    scratch();
+    fragmentation();
+
+    printf("%s\n", failed ? "vram: FAILED" : "vram: ok");
+    return failed;
+}
@@ -0,0 +1,118 @@
+/*
+  vtexsim - replay a pan/zoom path against the virtual texture
+
+    vtexsim [-b tiles_per_frame] [-v] [path]
+
+  Drives both faces (Mandelbrot and Julia) through src/vtex.c with the
+  tile pool in plain memory, then reports the tile hit rate, evictions
+  and texture compute time per frame, and exits 1 if the window a face
+  shows (vtex_window()) ever leaves the assembled texture. -v prints
+  one line per frame. The path defaults to host/vtex.path.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fractal.h"
+#include "vtex.h"
+
+static uint16_t pool[VT_POOL_BYTES / 2];
+static uint16_t faces[VT_FACES][256*256/2];
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = "host/vtex.path";
+    vt_camera cam = { 128.0, 128.0, 0 };
+    int budget = 2, verbose = 0, frames = 0, outside = 0;
+    double total = 0, worst = 0;
+    char line[256];
+    FILE *f;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-b") && i + 1 < argc)
+            budget = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-v"))
+            verbose = 1;
+        else if(argv[i][0] != '-')
+            path = argv[i];
+        else {
+            fprintf(stderr, "usage: %s [-b tiles_per_frame] [-v] [path]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if(!(f = fopen(path, "r"))) {
+        perror(path);
+        return 1;
+    }
+
+    fractal_init();
+    vtex_init(pool);
+
+    while(fgets(line, sizeof(line), f))
+    {
+        int n, zoom;
+        double dx, dy;
+
+        if(sscanf(line, "%d %lf %lf %d", &n, &dx, &dy, &zoom) != 4)
+            continue;
+
+        while(n--)
+        {
+            vt_stats before = vtex_stats;
+            double t0, t;
+            float u0, v0;
+
+            vtex_pan(&cam, dx, dy);
+
+            t0 = now();
+            vtex_begin_frame(budget);
+            vtex_assemble(faces[0], 0, 0, &cam);
+            vtex_assemble(faces[1], 1, 1, &cam);
+            t = now() - t0;
+
+            total += t;
+            if(t > worst)
+                worst = t;
+
+            vtex_window(&cam, &u0, &v0);
+            if(u0 < 0 || v0 < 0 || u0 * 256 + VT_WINDOW > 256 || v0 * 256 + VT_WINDOW > 256)
+                outside++;
+
+            if(verbose)
+                printf("frame %4d level %d  window %5.1f %5.1f  hits %3u misses %3u computed %3u fallbacks %3u evictions %3u  %8.3f ms\n",
+                       frames, cam.level, u0 * 256, v0 * 256,
+                       vtex_stats.hits - before.hits, vtex_stats.misses - before.misses,
+                       vtex_stats.computed - before.computed, vtex_stats.fallbacks - before.fallbacks,
+                       vtex_stats.evictions - before.evictions, t * 1e3);
+            frames++;
+        }
+
+        vtex_zoom(&cam, zoom);
+    }
+    fclose(f);
+
+    printf("frames %d, budget %d tiles/frame, pool %d tiles\n", frames, budget, VT_POOL);
+    printf("lookups %u, hit rate %.1f%%\n", vtex_stats.hits + vtex_stats.misses,
+           100.0 * vtex_stats.hits / (vtex_stats.hits + vtex_stats.misses));
+    printf("computed %u, fallbacks %u, evictions %u\n",
+           vtex_stats.computed, vtex_stats.fallbacks, vtex_stats.evictions);
+    printf("compute time per frame: mean %.3f ms, worst %.3f ms\n",
+           total / frames * 1e3, worst * 1e3);
+
+    if(outside) {
+        printf("FAIL: window outside the texture in %d frames\n", outside);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+  zoomsim - grid reuse across the levels of a zoom
+
+    zoomsim [-f formula] [-n levels] [x y]
+
+  Runs a zoom of the given levels (default 8) past level 0 towards
+  (x, y) in level 0 texels (default the centre, 128 128) with
+  tool/zoom.c, once copying the texels each level shares with the last
+  and once computing every texel. Prints each level's reused fraction,
+  then the totals and the speedup, and exits 1 if any level differs
+  between the two runs.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fractal.h"
+#include "timer.h"
+#include "zoom.h"
+
+#define MAX_LEVELS 24
+#define RUNS 3
+
+static zoom_seq z;
+static uint8_t levels[MAX_LEVELS + 1][256][256];
+
+/* The whole sequence, returns ticks; keep stores each level */
+static uint32_t run(int formula, int n, double x, double y, int keep, uint32_t *reused)
+{
+    uint32_t t = timer_ticks(), level_reused[MAX_LEVELS + 1];
+    int fail = 0;
+
+    zoom_start(&z, formula, x, y);
+    for(int l = 0; l <= n; l++)
+    {
+        uint32_t before = z.reused;
+
+        if(l)
+            zoom_step(&z, x, y);
+        level_reused[l] = z.reused - before;
+
+        if(keep)
+            memcpy(levels[l], z.counts, sizeof(z.counts));
+        else if(memcmp(levels[l], z.counts, sizeof(z.counts))) {
+            printf("level %d differs from computing every texel\n", l);
+            fail = 1;
+        }
+    }
+
+    t = timer_ticks() - t;
+    if(reused)
+        memcpy(reused, level_reused, sizeof(level_reused[0]) * (n + 1));
+    if(fail)
+        exit(1);
+
+    return t;
+}
+
+int main(int argc, char **argv)
+{
+    int formula = FRACTAL_MANDELBROT, n = 8, coords = 0;
+    double target[2] = { 128, 128 };
+    uint32_t reused[MAX_LEVELS + 1], full = 0xFFFFFFFF, fast = 0xFFFFFFFF;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-f") && i + 1 < argc) {
+            for(formula = 0; formula < FRACTAL_FORMULAS; formula++)
+                if(!strcmp(argv[i+1], fractal_formula_names[formula]))
+                    break;
+            i++;
+        }
+        else if(!strcmp(argv[i], "-n") && i + 1 < argc)
+            n = atoi(argv[++i]);
+        else if(argv[i][0] != '-' && coords < 2)
+            target[coords++] = atof(argv[i]);
+        else
+            formula = FRACTAL_FORMULAS;
+    }
+
+    if(formula == FRACTAL_FORMULAS || n < 1 || n > MAX_LEVELS || coords == 1) {
+        fprintf(stderr, "usage: %s [-f formula] [-n levels] [x y]\n", argv[0]);
+        return 1;
+    }
+
+    fractal_init();
+
+    zoom_reuse = 0;
+    for(int r = 0; r < RUNS; r++) {
+        uint32_t t = run(formula, n, target[0], target[1], r == 0, 0);
+
+        if(t < full)
+            full = t;
+    }
+
+    zoom_reuse = 1;
+    for(int r = 0; r < RUNS; r++) {
+        uint32_t t = run(formula, n, target[0], target[1], 0, reused);
+
+        if(t < fast)
+            fast = t;
+    }
+
+    for(int l = 1; l <= n; l++)
+        printf("level %2d: %5u texels reused (%4.1f%%)\n", l, reused[l], 100.0 * reused[l] / (256*256));
+
+    printf("%s, %d levels: %u of %u texels reused (%.1f%%), %.2f ms against %.2f ms, %.2fx\n",
+           fractal_formula_names[formula], n, z.reused, z.reused + z.computed,
+           100.0 * z.reused / (z.reused + z.computed), fast * 1e3 / TIMER_HZ, full * 1e3 / TIMER_HZ,
+           (double)full / fast);
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include "anim.h"
+
+
+
+/*
+ Animation decoder
+ */
+
+static int twiddle(int x)
+{
+    int t = 0;
+
+    for(int b = 0; b < 8; b++)
+        t |= (x >> b & 1) << 2*b;
+
+    return t;
+}
+
+static int nearest(double u)
+{
+    int i = (int)(u + 0.5);
+
+    return i < 0 ? 0 : i > 255 ? 255 : i;
+}
+
+/* For each twiddled texel, the texel of the previous frame that lands on
+   it after magnifying by zoom (16.16) about the centre */
+void anim_zoom_map(uint16_t *map, uint32_t zoom)
+{
+    double s = 65536.0 / zoom;
+
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            map[twiddle(i) << 1 | twiddle(j)] = twiddle(nearest(128 + (i - 128) * s)) << 1
+                                              | twiddle(nearest(128 + (j - 128) * s));
+}
+
+static void start_frame(anim *a)
+{
+    uint32_t offset = a->index[a->frame];
+    const uint32_t *frame = (const uint32_t*)(a->data + (offset & ~ANIM_KEY));
+
+    a->key = (offset & ANIM_KEY) != 0;
+    a->p = (const uint8_t*)(frame + 1);
+    a->end = a->p + frame[0];
+    a->pos = 0;
+}
+
+/* Returns 0 if data isn't an animation stream. work must hold
+   ANIM_WORK_BYTES; the first anim_step() calls decode frame 0 */
+int anim_open(anim *a, const uint8_t *data, uint8_t *work)
+{
+    const uint32_t *header = (const uint32_t*)data;
+
+    if(header[0] != ANIM_MAGIC || header[1] == 0)
+        return 0;
+
+    a->data = data;
+    a->frames = header[1];
+    a->index = header + ANIM_HEADER / 4;
+    a->frame_buf[0] = work;
+    a->frame_buf[1] = work + ANIM_FRAME_BYTES;
+    a->map = (uint16_t*)(work + 2*ANIM_FRAME_BYTES);
+    a->out = a->frame_buf[1];
+
+    anim_zoom_map(a->map, header[3]);
+    anim_seek(a, 0);
+    return 1;
+}
+
+/* Restart decoding from the keyframe at or before frame, showing nothing
+   until frame itself is complete */
+void anim_seek(anim *a, uint32_t frame)
+{
+    if(frame >= a->frames)
+        frame = a->frames - 1;
+
+    a->show = frame;
+    while(!(a->index[frame] & ANIM_KEY))
+        frame--;
+
+    a->frame = frame;
+    start_frame(a);
+}
+
+/* Decode about budget more texels. Returns 1 when a frame to show is
+   complete; a->out points at it until the next frame completes, so it
+   can be uploaded while decoding goes on (after the last frame comes
+   frame 0 again) */
+int anim_step(anim *a, uint32_t budget)
+{
+    uint8_t *dst = a->out == a->frame_buf[0] ? a->frame_buf[1] : a->frame_buf[0];
+    const uint8_t *prev = a->out;
+    const uint16_t *m = a->map + a->pos;
+    uint8_t *out = dst + a->pos;
+    uint8_t *stop = out + budget;
+    const uint8_t *p = a->p;
+
+    while(p < a->end && out < stop)
+    {
+        uint32_t c = *p++;
+
+        if(c < 0x80)
+        {
+            c++;
+            if(a->key)
+                while(c--)
+                    *out++ = *p++;
+            else
+                while(c--)
+                    *out++ = prev[*m++] + *p++;
+        }
+        else
+        {
+            uint8_t v = *p++;
+
+            c = (c & 0x7f) + 3;
+            if(a->key)
+                while(c--)
+                    *out++ = v;
+            else
+                while(c--)
+                    *out++ = prev[*m++] + v;
+        }
+    }
+
+    a->p = p;
+    a->pos = out - dst;
+
+    if(p < a->end)
+        return 0;
+
+    /* Frame complete, it's the prediction for the next one */
+    a->out = dst;
+
+    if(++a->frame == a->frames)
+        a->frame = a->show = 0;
+    else if(a->frame <= a->show) {
+        start_frame(a);
+        return 0;
+    }
+
+    start_frame(a);
+    return 1;
+}
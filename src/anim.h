@@ -0,0 +1,62 @@
+#ifndef ANIM_H_INCLUDED
+#define ANIM_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Streamed iteration map animation
+
+  Frames are 256x256 PAL8 textures in twiddled byte order, exactly what
+  goes into a tex[] slot. Stream layout (little endian, 4 byte aligned):
+
+    u32 ANIM_MAGIC
+    u32 frame count
+    u32 keyframe interval the encoder used
+    u32 zoom, 16.16 magnification from one frame to the next
+    u32 index[frame count]  offset of each frame from the start of the
+                            stream, ANIM_KEY set on keyframes
+    frames: u32 payload size, payload, padding to 4 bytes
+
+  A keyframe payload codes the texels. A delta frame codes each texel
+  minus its prediction (mod 256): the nearest texel of the previous frame
+  magnified by zoom about the texture centre, so a steady zoom mostly
+  predicts itself. Payloads are run-length coded:
+
+    c < 0x80    c + 1 bytes follow verbatim
+    c >= 0x80   the next byte repeated (c & 0x7f) + 3 times
+
+  Frame 0 is always a keyframe, so playback can loop and seek from the
+  index.
+*/
+
+#define ANIM_MAGIC       0x494E4146 /* "FANI" */
+#define ANIM_KEY         0x80000000
+#define ANIM_HEADER      16
+#define ANIM_FRAME_BYTES (256*256)
+
+/* Two frames and the prediction map */
+#define ANIM_WORK_BYTES  (4 * ANIM_FRAME_BYTES)
+
+typedef struct
+{
+    const uint8_t *data;
+    const uint32_t *index;
+    uint32_t frames;
+
+    uint32_t frame;         /* frame being decoded */
+    uint32_t show;          /* earlier frames are only decoded, for seeking */
+    int key;
+    const uint8_t *p, *end; /* payload left of this frame */
+    uint32_t pos;           /* texels of this frame done */
+
+    uint8_t *frame_buf[2];  /* the frame being decoded and the one before */
+    uint16_t *map;          /* where each texel is predicted from */
+    uint8_t *out;           /* last frame completed */
+} anim;
+
+void anim_zoom_map(uint16_t *map, uint32_t zoom);
+int anim_open(anim *a, const uint8_t *data, uint8_t *work);
+void anim_seek(anim *a, uint32_t frame);
+int anim_step(anim *a, uint32_t budget);
+
+#endif /* ANIM_H_INCLUDED */
@@ -2,6 +2,136 @@
 	
     .text
 
+.ifdef PACKED
+
+    ! Packed build (make packed): a.bin compressed by tool/dcpack follows
+    ! this stub. The unpacker and the payload are first moved to the top
+    ! of RAM, the image is unpacked to 0x8C010000 through P2 and the normal
+    ! start below is entered there.
+
+start:
+    stc	sr,r0
+    or #0xf0,r0
+    ldc	r0,sr
+    mov.l p2_mask,r0
+    mov.l unpack_addr,r4
+    or r0,r4
+    mov.l payload_addr,r6
+    or r0,r6
+    mov.l @(4,r6),r1
+    sub r4,r6
+    add #8+3,r1
+    add r6,r1
+    shlr2 r1
+    mov.l reloc_addr,r5
+    mov r4,r3
+    mov r5,r2
+.reloc:
+    mov.l @r3+,r0
+    dt r1
+    mov.l r0,@r2
+    bf/s .reloc
+    add #4,r2
+    mov r5,r0
+    mov r5,r4
+    add r6,r4
+    mov.l image_p2_addr,r5
+    jmp	@r0
+    nop
+
+    .align 2
+p2_mask:
+    .long 0xA0000000
+unpack_addr:
+    .long unpack
+payload_addr:
+    .long payload
+reloc_addr:
+    .long 0xACF00000
+image_p2_addr:
+    .long 0xAC010000
+
+
+    ! Position independent from here to the payload, see tool/lzss.c
+    !
+    ! r4 = packed stream
+    ! r5 = destination
+
+    .align 2
+unpack:
+    mov.l @r4+,r6
+    add #4,r4
+    add r5,r6
+.flags:
+    mov.b @r4+,r0
+    extu.b r0,r7
+    mov #8,r3
+.item:
+    cmp/hs r6,r5
+    bt .done
+    shlr r7
+    bf .match
+    mov.b @r4+,r0
+    mov.b r0,@r5
+    bra .next
+    add #1,r5
+.match:
+    mov.b @r4+,r0
+    extu.b r0,r1
+    mov.b @r4+,r0
+    extu.b r0,r2
+    mov r2,r0
+    and #0xf0,r0
+    shll2 r0
+    shll2 r0
+    or r0,r1
+    mov r2,r0
+    and #0x0f,r0
+    add #3,r0
+    mov r5,r2
+    sub r1,r2
+.copy:
+    mov.b @r2+,r1
+    dt r0
+    mov.b r1,@r5
+    bf/s .copy
+    add #1,r5
+.next:
+    dt r3
+    bf .item
+    bra .flags
+    nop
+.done:
+    mov.l ccr_addr,r1
+    mov.l @r1,r0
+    mov.l ccr_ici_oci,r2
+    or r2,r0
+    mov.l r0,@r1
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    nop
+    mov.l image_addr,r0
+    jmp	@r0
+    nop
+
+    .align 2
+ccr_addr:
+    .long 0xFF00001C
+ccr_ici_oci:
+    .long 0x00000808                ! ICI | OCI: drop both caches' stale lines
+image_addr:
+    .long 0x8C010000
+
+    .align 2
+payload:
+
+.else
+
 start:
     stc	sr,r0
     or #0xf0,r0
@@ -73,4 +203,6 @@ ccr_addr:
 ccr_data:
     .word 0x090B
 
+.endif
+
     .end
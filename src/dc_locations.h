@@ -1,8 +1,14 @@
 #ifndef DC_LOCATIONS_H_INCLUDED
 #define DC_LOCATIONS_H_INCLUDED
 
+#ifdef __sh__
 #define VRAM_BASE    0xA5000000
 #define VRAM64_BASE  0xA4000000
+#else
+#include "hal.h"
+#define VRAM_BASE    ((uintptr_t)hal_vram)
+#define VRAM64_BASE  ((uintptr_t)hal_vram64)
+#endif
 
 #define VRAM_BANK1_BASE 0x00000000
 #define VRAM_BANK1_END  0x003FFFFC
@@ -10,6 +16,14 @@
 #define VRAM_BANK2_BASE 0x00400000
 #define VRAM_BANK2_END  0x007FFFFC
 
+#ifdef __sh__
+#define PAL_RAM_BASE 0xA05F9000
+
 #define TA_Area (uint32_t*)0x10000000
+#else
+#define PAL_RAM_BASE ((uintptr_t)hal_palette)
+
+#define TA_Area ((uint32_t*)hal_ta_area)
+#endif
 
 #endif /* DC_LOCATIONS_H_INCLUDED */
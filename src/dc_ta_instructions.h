@@ -204,6 +204,8 @@
 
 #define TA_TSP_U_256                           ( 5 << 3 )
 #define TA_TSP_V_256                           ( 5 << 0 )
+#define TA_TSP_V_512                           ( 6 << 0 )
+#define TA_TSP_V_1024                          ( 7 << 0 )
 
 
 
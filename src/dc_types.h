@@ -0,0 +1,16 @@
+#ifndef DC_TYPES_H_INCLUDED
+#define DC_TYPES_H_INCLUDED
+
+/* The console build has no libc headers; host tools get the real ones */
+#ifdef __sh__
+typedef unsigned char  uint8_t;
+typedef unsigned short uint16_t;
+typedef unsigned long  uint32_t;
+typedef signed char    int8_t;
+typedef short          int16_t;
+typedef long           int32_t;
+#else
+#include <stdint.h>
+#endif
+
+#endif /* DC_TYPES_H_INCLUDED */
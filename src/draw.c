@@ -0,0 +1,384 @@
+#include "draw.h"
+#include "dc_ta_instructions.h"
+
+
+
+/*
+ Draw list
+ */
+
+int draw_sorted = 1;
+int draw_sprites = 1;
+uint32_t draw_headers, draw_bytes, draw_sprite_quads;
+void (*draw_send)(const void *packet);
+
+static draw_item items[DRAW_MAX_QUADS];
+static uint8_t state[DRAW_MAX_QUADS];
+static uint16_t order[DRAW_MAX_QUADS];
+static int count;
+
+/* Quads each quad overlaps further on: overlap[later[q]] up to
+   overlap[later[q + 1]], and how many earlier ones each waits for */
+static uint16_t later[DRAW_MAX_QUADS + 1], overlap[DRAW_MAX_OVERLAPS], need[DRAW_MAX_QUADS];
+
+/* state[] of a quad draw_end() has ordered */
+#define SENT 0xFF
+
+/* Distinct states of this frame, in order of first use. Quads past the
+   last one share its index and get a header whenever the state changes */
+static struct
+{
+    uint32_t size, texture;
+    int sprite;
+} states[DRAW_MAX_STATES];
+static int state_count;
+
+static uint32_t ta_parameter[8] =
+{
+ GROUP_ENABLE_TA
+ | POLYGON_VOLUME_TA
+ | OUTSIDE_ENABLED_USER_CLIP_TA
+ | STRIPS_6_TA
+ | TEXTURE_TA,
+
+ TA_ISP_TSP_DEPTH_COMPARE_MODE_ALWAYS
+ | TA_ISP_TSP_CULL_IF_NEG,
+
+ TA_TSP_SRC_ALPHA_INSTRUCTION_ONE
+ | TA_TSP_DST_ALPHA_INSTRUCTION_ZERO
+ | TA_TSP_FOG_NO_FOG
+ | TA_TSP_FILTER_MODE_BILINEAR
+};
+
+/* Words 4 and 5 are the base and offset colours, sprite vertices have none */
+static uint32_t sprite_parameter[8] =
+{
+ GROUP_ENABLE_TA
+ | SPRITE_TA
+ | OUTSIDE_ENABLED_USER_CLIP_TA
+ | TEXTURE_TA
+ | UV_16BIT_TA,
+
+ TA_ISP_TSP_DEPTH_COMPARE_MODE_ALWAYS
+ | TA_ISP_TSP_CULL_IF_NEG,
+
+ TA_TSP_SRC_ALPHA_INSTRUCTION_ONE
+ | TA_TSP_DST_ALPHA_INSTRUCTION_ZERO
+ | TA_TSP_FOG_NO_FOG
+ | TA_TSP_FILTER_MODE_BILINEAR,
+
+ 0,
+ 0xFFFFFFFF,
+ 0
+};
+
+/* Largest depth, in NDC, of a fourth corner off the plane of the other
+   three for the quad to go as a sprite */
+#define SPRITE_TOLERANCE (1.0f / 4096)
+
+/* Pixels two quads may share along an edge without overlapping */
+#define OVERLAP_TOLERANCE (1.0f / 64)
+
+static struct
+{
+  uint32_t flag;
+  float x, y, z;
+  float u, v;
+  uint32_t color;
+  uint32_t offset_color;
+} vert;
+
+/* Corners A, B, C, D go round the quad: strip vertices 0, 1, 3, 2 */
+static struct
+{
+  uint32_t flag;
+  float ax, ay, az;
+  float bx, by, bz;
+  float cx, cy, cz;
+  float dx, dy;
+  uint32_t pad;
+  uint32_t auv, buv, cuv;
+} sprite;
+
+/* PAL8 texture at offset in the 64-bit VRAM space, with palette bank pal */
+uint32_t draw_texture_word(uint32_t offset, int pal)
+{
+    return 6 << 27
+         | pal << 25
+         | offset >> 3;
+}
+
+void draw_begin()
+{
+    count = state_count = 0;
+}
+
+static int find_state(uint32_t size, uint32_t texture, int sprite)
+{
+    int s;
+
+    for(s = 0; s < state_count; s++)
+        if(states[s].texture == texture && states[s].size == size && states[s].sprite == sprite)
+            return s;
+
+    if(state_count == DRAW_MAX_STATES)
+        return DRAW_MAX_STATES - 1;
+
+    states[s].size = size;
+    states[s].texture = texture;
+    states[s].sprite = sprite;
+    state_count++;
+    return s;
+}
+
+/* Whether strip vertex 2, sprite corner D, lies on the plane through
+   the others in screen x, y and depth */
+static int coplanar(const float (*p)[3])
+{
+    float e1x = p[1][0] - p[0][0], e1y = p[1][1] - p[0][1];
+    float e2x = p[3][0] - p[0][0], e2y = p[3][1] - p[0][1];
+    float dx = p[2][0] - p[0][0], dy = p[2][1] - p[0][1];
+    float det = e1x*e2y - e1y*e2x, s, t;
+
+    /* Edge on, nothing to gain */
+    if(__builtin_fabsf(det) < 1.0f)
+        return 0;
+
+    s = (dx*e2y - dy*e2x) / det;
+    t = (e1x*dy - e1y*dx) / det;
+
+    return __builtin_fabsf(p[0][2] + s*(p[1][2] - p[0][2]) + t*(p[3][2] - p[0][2]) - p[2][2]) <= SPRITE_TOLERANCE;
+}
+
+/* Twice the signed area of the strip's outline, negative when the TA
+   culls it (TA_ISP_TSP_CULL_IF_NEG) */
+static float area2(const float (*p)[3])
+{
+    return (p[0][0] - p[3][0]) * (p[1][1] - p[2][1]) - (p[1][0] - p[2][0]) * (p[0][1] - p[3][1]);
+}
+
+/* The normals of the quad's outline and its extent along each */
+static void outline(draw_item *d)
+{
+    static const int corner[4] = { 0, 1, 3, 2 };
+
+    for(int e = 0; e < 4; e++)
+    {
+        const float *p0 = d->p[corner[e]], *p1 = d->p[corner[(e + 1) & 3]];
+        float *a = d->axis[e];
+
+        a[0] = p1[1] - p0[1];
+        a[1] = p0[0] - p1[0];
+        a[2] = a[3] = a[0] * p0[0] + a[1] * p0[1];
+
+        for(int k = 0; k < 4; k++) {
+            float t = a[0] * d->p[k][0] + a[1] * d->p[k][1];
+
+            a[2] = t < a[2] ? t : a[2];
+            a[3] = t > a[3] ? t : a[3];
+        }
+    }
+}
+
+/* Whether b lies to one side of one of a's outline normals, but for
+   OVERLAP_TOLERANCE */
+static int separates(const draw_item *a, const draw_item *b)
+{
+    for(int e = 0; e < 4; e++)
+    {
+        const float *n = a->axis[e];
+        float slack = (__builtin_fabsf(n[0]) + __builtin_fabsf(n[1])) * OVERLAP_TOLERANCE;
+        float lo = n[0] * b->p[0][0] + n[1] * b->p[0][1], hi = lo;
+
+        for(int k = 1; k < 4; k++) {
+            float t = n[0] * b->p[k][0] + n[1] * b->p[k][1];
+
+            lo = t < lo ? t : lo;
+            hi = t > hi ? t : hi;
+        }
+
+        if(hi <= n[2] + slack || n[3] <= lo + slack)
+            return 1;
+    }
+
+    return 0;
+}
+
+/* Whether two quads' outlines overlap on screen, by their bounds, then
+   by separating axes. Sharing an edge, as neighbouring faces do, isn't
+   overlapping */
+static int overlaps(const draw_item *a, const draw_item *b)
+{
+    if(a->x1 <= b->x0 || b->x1 <= a->x0 || a->y1 <= b->y0 || b->y1 <= a->y0)
+        return 0;
+
+    return !separates(a, b) && !separates(b, a);
+}
+
+/* Whether a UV survives pack_uv() */
+static int packs(float f)
+{
+    union { float f; uint32_t w; } a = { f };
+
+    return !(a.w & 0xFFFF);
+}
+
+/* Top 16 bits of u and v */
+static uint32_t pack_uv(float u, float v)
+{
+    union { float f; uint32_t w; } a = { u }, b = { v };
+
+    return (a.w & 0xFFFF0000) | b.w >> 16;
+}
+
+void draw_quad(const float *p1, const float *p2, const float *p3, const float *p4,
+               uint32_t size, uint32_t texture, float u0, float u1, float v0, float v1)
+{
+    const float *p[4] = { p1, p2, p3, p4 };
+    draw_item *d;
+
+    if(count == DRAW_MAX_QUADS)
+        return;
+
+    d = &items[count];
+    d->x0 = d->x1 = p1[0];
+    d->y0 = d->y1 = p1[1];
+    for(int k = 0; k < 4; k++) {
+        d->p[k][0] = p[k][0];
+        d->p[k][1] = p[k][1];
+        d->p[k][2] = p[k][2];
+        d->x0 = p[k][0] < d->x0 ? p[k][0] : d->x0;
+        d->x1 = p[k][0] > d->x1 ? p[k][0] : d->x1;
+        d->y0 = p[k][1] < d->y0 ? p[k][1] : d->y0;
+        d->y1 = p[k][1] > d->y1 ? p[k][1] : d->y1;
+    }
+    d->u0 = u0;
+    d->u1 = u1;
+    d->v0 = v0;
+    d->v1 = v1;
+    d->size = size;
+    d->texture = texture;
+    d->sprite = draw_sprites && packs(u0) && packs(u1) && packs(v0) && packs(v1) && coplanar(d->p);
+    d->culled = area2(d->p) <= 0;
+    if(!d->culled)
+        outline(d);
+
+    state[count] = find_state(size, texture, d->sprite);
+    count++;
+}
+
+static void send(const void *packet)
+{
+    draw_send(packet);
+    draw_bytes += 32;
+}
+
+void draw_end()
+{
+    const draw_item *last = 0;
+    int sorted = draw_sorted;
+
+    /* With TA_ISP_TSP_DEPTH_COMPARE_MODE_ALWAYS the later of two
+       overlapping quads covers the other, so that is the only order that
+       shows. need[] counts the earlier quads a quad overlaps that are
+       still to go; each pass sends the state of the first quad left, each
+       of its quads as its count comes to 0. Culled quads draw nothing and
+       go anywhere. With more overlaps than fit, quads go in submission
+       order */
+    if(sorted)
+    {
+        int pairs = 0;
+
+        for(int q = 0; q < count; q++)
+            need[q] = 0;
+
+        for(int m = 0; m < count && sorted; m++)
+        {
+            later[m] = pairs;
+
+            for(int q = m + 1; q < count && !items[m].culled; q++)
+                if(!items[q].culled && overlaps(&items[m], &items[q]))
+                {
+                    if(pairs == DRAW_MAX_OVERLAPS) {
+                        sorted = 0;
+                        break;
+                    }
+                    overlap[pairs++] = q;
+                    need[q]++;
+                }
+        }
+        later[count] = pairs;
+    }
+
+    if(sorted)
+    {
+        int first = 0, n = 0;
+
+        while(n < count)
+        {
+            int s;
+
+            while(state[first] == SENT)
+                first++;
+            s = state[first];
+
+            for(int q = first; q < count; q++)
+                if(state[q] == s && !need[q])
+                {
+                    order[n++] = q;
+                    state[q] = SENT;
+
+                    for(int k = later[q]; k < later[q + 1]; k++)
+                        need[overlap[k]]--;
+                }
+        }
+    }
+    else
+        for(int n = 0; n < count; n++)
+            order[n] = n;
+
+    draw_headers = draw_bytes = draw_sprite_quads = 0;
+
+    for(int n = 0; n < count; n++)
+    {
+        const draw_item *d = &items[order[n]];
+
+        if(!sorted || !last || d->texture != last->texture || d->size != last->size || d->sprite != last->sprite)
+        {
+            uint32_t *header = d->sprite ? sprite_parameter : ta_parameter;
+
+            header[2] = (header[2] & ~0x3f) | d->size;
+            header[3] = d->texture;
+            send(header);
+            draw_headers++;
+        }
+        last = d;
+
+        if(d->sprite)
+        {
+            sprite.flag = END_OF_STRIP_TA;
+            sprite.ax = d->p[0][0]; sprite.ay = d->p[0][1]; sprite.az = d->p[0][2];
+            sprite.bx = d->p[1][0]; sprite.by = d->p[1][1]; sprite.bz = d->p[1][2];
+            sprite.cx = d->p[3][0]; sprite.cy = d->p[3][1]; sprite.cz = d->p[3][2];
+            sprite.dx = d->p[2][0]; sprite.dy = d->p[2][1];
+            sprite.auv = pack_uv(d->u0, d->v0);
+            sprite.buv = pack_uv(d->u1, d->v0);
+            sprite.cuv = pack_uv(d->u1, d->v1);
+            send(&sprite);
+            send((const uint32_t*)&sprite + 8);
+            draw_sprite_quads++;
+            continue;
+        }
+
+        for(int k = 0; k < 4; k++)
+        {
+            vert.flag = k == 3 ? END_OF_STRIP_TA : VERTEX_TA;
+            vert.x = d->p[k][0];
+            vert.y = d->p[k][1];
+            vert.z = d->p[k][2];
+            vert.u = k & 1 ? d->u1 : d->u0;
+            vert.v = k & 2 ? d->v1 : d->v0;
+            send(&vert);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef DRAW_H_INCLUDED
+#define DRAW_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Sorted submission of textured quads
+
+  Quads are collected between draw_begin() and draw_end() with the
+  render state they need: the texture size bits of TSP word 2 and the
+  texture control word (format, palette, address). draw_end() groups
+  them by state and sends one global parameter per run of equal state, then
+  each quad as a 4 vertex strip, through draw_send 32 bytes at a time.
+  The depth compare is TA_ISP_TSP_DEPTH_COMPARE_MODE_ALWAYS, so where
+  two quads overlap on screen the later one shows: the grouping never
+  moves a quad ahead of an earlier one it overlaps, and a run of state
+  breaks where it would have to. Quads facing away, which the TA culls,
+  and quads that don't overlap go in any order.
+
+  A quad whose corners are coplanar in screen space goes as a sprite
+  instead: one 64 byte vertex parameter in place of four 32 byte ones.
+  The TA takes the depth and UV of a sprite's fourth corner from the
+  other three, as the plane through them and the parallelogram A + C - B,
+  so it only gets the corners' x, y, z and three UVs at 16 bits each.
+  Quads whose UVs don't fit in 16 bits, like the VTEX build's panning
+  windows, stay strips. Sprites and strips are different states.
+*/
+
+#define DRAW_MAX_QUADS  512
+#define DRAW_MAX_STATES 32
+#define DRAW_MAX_OVERLAPS 8192
+
+typedef struct
+{
+    float p[4][3];
+    float x0, y0, x1, y1;   /* screen bounds */
+    float axis[4][4];   /* outline normals x, y and the quad's extent along them */
+    float u0, u1, v0, v1;   /* the quad's rectangle of the texture */
+    uint32_t size;      /* TA_TSP_U_* | TA_TSP_V_* */
+    uint32_t texture;
+    int sprite;         /* coplanar, sent as a sprite */
+    int culled;         /* facing away, the TA drops it */
+} draw_item;
+
+/* 0 sends a global parameter before every quad, in submission order */
+extern int draw_sorted;
+
+/* 0 sends every quad as a strip */
+extern int draw_sprites;
+
+
+/* Global parameters, bytes and sprites sent by the last draw_end() */
+extern uint32_t draw_headers, draw_bytes, draw_sprite_quads;
+
+extern void (*draw_send)(const void *packet);
+
+uint32_t draw_texture_word(uint32_t offset, int pal);
+void draw_begin();
+void draw_quad(const float *p1, const float *p2, const float *p3, const float *p4,
+               uint32_t size, uint32_t texture, float u0, float u1, float v0, float v1);
+void draw_end();
+
+#endif /* DRAW_H_INCLUDED */
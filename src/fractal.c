@@ -0,0 +1,669 @@
+#include "fractal.h"
+#include "timer.h"
+
+#ifdef FRACTAL_STATS
+#include <string.h>
+#endif
+
+
+
+/*
+ Mandelbrot
+ */
+
+int twiddletab[1024];
+
+void fractal_init()
+{
+    for(int x=0; x<1024; x++)
+      twiddletab[x] = (x&1)|((x&2)<<1)|((x&4)<<2)|((x&8)<<3)|((x&16)<<4)|((x&32)<<5)|((x&64)<<6)|((x&128)<<7)|((x&256)<<8)|((x&512)<<9);
+}
+
+/*
+ Upload
+ */
+
+#define UPLOAD_BURST 32
+
+static void *copy_words(void *dest, const void *src, int n)
+{
+    uint32_t *d = (uint32_t*)dest;
+    const uint32_t *s = (const uint32_t*)src;
+
+    for(n >>= 2; n--; )
+        *d++ = *s++;
+
+    return dest;
+}
+
+void *(*fractal_upload)(void *dest, const void *src, int n) = copy_words;
+
+/* Two blocks, one being filled while the other is sent */
+static uint32_t staging[2][FRACTAL_BLOCK*FRACTAL_BLOCK / 4] __attribute__((aligned(32)));
+
+static const uint32_t *pending_src;
+static uint32_t *pending_dst;
+static int pending_bursts;
+
+static void upload_burst()
+{
+    if(pending_bursts) {
+        fractal_upload(pending_dst, pending_src, UPLOAD_BURST);
+        pending_src += UPLOAD_BURST / 4;
+        pending_dst += UPLOAD_BURST / 4;
+        pending_bursts--;
+    }
+}
+
+static void upload_flush()
+{
+    while(pending_bursts)
+        upload_burst();
+}
+
+/* Escape time of the point at texel coordinates (x, y) */
+static inline uint32_t escape_time(double x, double y, int julia)
+{
+  float c_re = (x-128)*(1.0/16384)-1.313747;
+  float c_im = (y-128)*(1.0/16384)-0.073227;
+  float z_re = 0.0;
+  float z_im = 0.0;
+  int n=-1;
+
+  if(julia) {
+    z_re = c_re;
+    z_im = c_im;
+    c_re = -1.313747;
+    c_im = -0.073227;
+  }
+
+  do {
+    float tmp_r = z_re;
+    z_re = z_re*z_re - z_im*z_im + c_re;
+    z_im = 2*tmp_r*z_im + c_im;
+  } while(++n<255 && z_re*z_re+z_im*z_im<=2.0);
+
+  return n;
+}
+
+/*
+ Formula family
+
+ One kernel per formula, each inlined with its formula as a constant so
+ the switch in the loop folds away. Mandelbrot and Julia keep
+ escape_time() above so their textures don't change.
+ */
+
+typedef struct
+{
+    double re, im;      /* point at texel (128, 128) */
+    double scale;       /* per texel */
+} view;
+
+static const view views[FRACTAL_FORMULAS] = {
+    [FRACTAL_MULTIBROT3]   = {  0.0,   0.0, 1.0/96 },
+    [FRACTAL_MULTIBROT4]   = {  0.0,   0.0, 1.0/100 },
+    [FRACTAL_BURNING_SHIP] = { -0.45, -0.5, 1.0/80 },
+    [FRACTAL_TRICORN]      = { -0.3,   0.0, 1.0/90 },
+};
+
+static inline __attribute__((always_inline))
+uint32_t escape_formula(double x, double y, const int formula)
+{
+  float c_re = (x-128)*views[formula].scale+views[formula].re;
+  float c_im = (y-128)*views[formula].scale+views[formula].im;
+  float z_re = 0.0;
+  float z_im = 0.0;
+  int n=-1;
+
+  do {
+    float re2 = z_re*z_re, im2 = z_im*z_im, a, b;
+
+    switch(formula) {
+    case FRACTAL_MULTIBROT3:        /* z^3 + c */
+      a = z_re*(re2 - 3*im2);
+      z_im = z_im*(3*re2 - im2) + c_im;
+      z_re = a + c_re;
+      break;
+    case FRACTAL_MULTIBROT4:        /* z^4 + c */
+      a = re2 - im2;
+      b = 2*z_re*z_im;
+      z_re = a*a - b*b + c_re;
+      z_im = 2*a*b + c_im;
+      break;
+    case FRACTAL_BURNING_SHIP:      /* (|re z| + i |im z|)^2 + c */
+      z_im = 2*__builtin_fabsf(z_re*z_im) + c_im;
+      z_re = re2 - im2 + c_re;
+      break;
+    case FRACTAL_TRICORN:           /* conj(z)^2 + c */
+      z_im = -2*z_re*z_im + c_im;
+      z_re = re2 - im2 + c_re;
+      break;
+    }
+  } while(++n<255 && z_re*z_re+z_im*z_im<=4.0f);
+
+  return n;
+}
+
+static uint32_t escape_multibrot3(double x, double y)   { return escape_formula(x, y, FRACTAL_MULTIBROT3); }
+static uint32_t escape_multibrot4(double x, double y)   { return escape_formula(x, y, FRACTAL_MULTIBROT4); }
+static uint32_t escape_burning_ship(double x, double y) { return escape_formula(x, y, FRACTAL_BURNING_SHIP); }
+static uint32_t escape_tricorn(double x, double y)      { return escape_formula(x, y, FRACTAL_TRICORN); }
+
+const char *fractal_formula_names[FRACTAL_FORMULAS] = {
+    "mandelbrot", "julia", "multibrot3", "multibrot4", "burning_ship", "tricorn"
+};
+
+/* Escape time of one texel, dispatched once per texel */
+uint32_t compute_sample(double x, double y, int formula)
+{
+  switch(formula) {
+  case FRACTAL_MANDELBROT:   return escape_time(x, y, 0);
+  case FRACTAL_JULIA:        return escape_time(x, y, 1);
+  case FRACTAL_MULTIBROT3:   return escape_multibrot3(x, y);
+  case FRACTAL_MULTIBROT4:   return escape_multibrot4(x, y);
+  case FRACTAL_BURNING_SHIP: return escape_burning_ship(x, y);
+  case FRACTAL_TRICORN:      return escape_tricorn(x, y);
+  }
+  return 0;
+}
+
+/* Point at texel (128, 128) of level 0 and the width of a texel; for
+   Julia the point is z0, c is fixed */
+void fractal_view(int formula, double *re, double *im, double *scale)
+{
+  if(formula <= FRACTAL_JULIA) {
+    *re = -1.313747;
+    *im = -0.073227;
+    *scale = 1.0/16384;
+  } else {
+    *re = views[formula].re;
+    *im = views[formula].im;
+    *scale = views[formula].scale;
+  }
+}
+
+uint32_t compute_texture(int x, int y, int formula)
+{
+  return compute_sample(x, y, formula);
+}
+
+/* Level L magnifies the view 2^L times around the centre texel, so the
+   256 texels of level 0 span 256 << L texels; negative levels are the
+   same view at 256 >> -L texels. Width of a level L texel, and a level
+   L texel coordinate mapped back to level 0 texel units. */
+static inline double level_step(int level)
+{
+  return level >= 0 ? 1.0 / (1 << level) : (double)(1 << -level);
+}
+
+static inline double level_coord(double u, int level)
+{
+  if(level < 0)
+    return 128 + (u - (128 >> -level)) * (1 << -level);
+
+  return 128 + (u - (128 << level)) * (1.0 / (1 << level));
+}
+
+
+
+/*
+ Kernels
+
+ Row kernels compute n texels at (x, y), (x, y + step), ... Each one
+ gives the same counts as escape_time() bit for bit, they differ only in
+ how the work is scheduled on the FPU.
+ */
+
+static void row_scalar(uint8_t *dst, double x, double y, double step, int n, int julia)
+{
+    for(int k = 0; k < n; k++)
+        dst[k] = escape_time(x, y + k*step, julia);
+}
+
+/* Two texels at once, so one's multiplies fill the other's latency */
+static void row_pair(uint8_t *dst, double x, double y, double step, int n, int julia)
+{
+    for(int k = 0; k < n; k += 2)
+    {
+        float c_re0 = (x-128)*(1.0/16384)-1.313747;
+        float c_im0 = (y+k*step-128)*(1.0/16384)-0.073227;
+        float c_re1 = c_re0;
+        float c_im1 = (y+(k+1)*step-128)*(1.0/16384)-0.073227;
+        float z_re0 = 0.0, z_im0 = 0.0;
+        float z_re1 = 0.0, z_im1 = 0.0;
+        int n0 = -1, n1 = -1, a0, a1;
+
+        if(julia) {
+            z_re0 = c_re0; z_im0 = c_im0;
+            z_re1 = c_re1; z_im1 = c_im1;
+            c_re0 = c_re1 = -1.313747;
+            c_im0 = c_im1 = -0.073227;
+        }
+
+        do {
+            float tmp_r0 = z_re0, tmp_r1 = z_re1;
+            z_re0 = z_re0*z_re0 - z_im0*z_im0 + c_re0;
+            z_re1 = z_re1*z_re1 - z_im1*z_im1 + c_re1;
+            z_im0 = 2*tmp_r0*z_im0 + c_im0;
+            z_im1 = 2*tmp_r1*z_im1 + c_im1;
+            a0 = ++n0<255 && z_re0*z_re0+z_im0*z_im0<=2.0;
+            a1 = ++n1<255 && z_re1*z_re1+z_im1*z_im1<=2.0;
+        } while(a0 && a1);
+
+        /* Finish whichever hasn't escaped on its own */
+        while(a0) {
+            float tmp_r = z_re0;
+            z_re0 = z_re0*z_re0 - z_im0*z_im0 + c_re0;
+            z_im0 = 2*tmp_r*z_im0 + c_im0;
+            a0 = ++n0<255 && z_re0*z_re0+z_im0*z_im0<=2.0;
+        }
+        while(a1) {
+            float tmp_r = z_re1;
+            z_re1 = z_re1*z_re1 - z_im1*z_im1 + c_re1;
+            z_im1 = 2*tmp_r*z_im1 + c_im1;
+            a1 = ++n1<255 && z_re1*z_re1+z_im1*z_im1<=2.0;
+        }
+
+        dst[k] = n0;
+        dst[k+1] = n1;
+    }
+}
+
+/* k iterations between bailout checks. The bailout compares are still
+   made every iteration but only OR'd together, so the loop body has no
+   branch; a batch that escaped somewhere is replayed from its saved z
+   one checked iteration at a time for the exact count. */
+static inline uint32_t escape_unrolled(double x, double y, int julia, const int k)
+{
+  float c_re = (x-128)*(1.0/16384)-1.313747;
+  float c_im = (y-128)*(1.0/16384)-0.073227;
+  float z_re = 0.0;
+  float z_im = 0.0;
+  int n=-1;
+
+  if(julia) {
+    z_re = c_re;
+    z_im = c_im;
+    c_re = -1.313747;
+    c_im = -0.073227;
+  }
+
+  /* Whole batches while they can't run into the iteration limit */
+  while(n+k < 255) {
+    float save_re = z_re, save_im = z_im;
+    int escaped = 0;
+
+    for(int s=0; s<k; s++) {
+      float tmp_r = z_re;
+      z_re = z_re*z_re - z_im*z_im + c_re;
+      z_im = 2*tmp_r*z_im + c_im;
+      escaped |= !(z_re*z_re+z_im*z_im<=2.0);
+    }
+
+    if(escaped) {
+      z_re = save_re;
+      z_im = save_im;
+      break;
+    }
+    n += k;
+  }
+
+  /* The escaping batch, or the last few iterations before the limit */
+  do {
+    float tmp_r = z_re;
+    z_re = z_re*z_re - z_im*z_im + c_re;
+    z_im = 2*tmp_r*z_im + c_im;
+  } while(++n<255 && z_re*z_re+z_im*z_im<=2.0);
+
+  return n;
+}
+
+static void row_unroll2(uint8_t *dst, double x, double y, double step, int n, int julia)
+{
+    for(int k = 0; k < n; k++)
+        dst[k] = escape_unrolled(x, y + k*step, julia, 2);
+}
+
+static void row_unroll4(uint8_t *dst, double x, double y, double step, int n, int julia)
+{
+    for(int k = 0; k < n; k++)
+        dst[k] = escape_unrolled(x, y + k*step, julia, 4);
+}
+
+static void row_unroll8(uint8_t *dst, double x, double y, double step, int n, int julia)
+{
+    for(int k = 0; k < n; k++)
+        dst[k] = escape_unrolled(x, y + k*step, julia, 8);
+}
+
+static void row_unroll16(uint8_t *dst, double x, double y, double step, int n, int julia)
+{
+    for(int k = 0; k < n; k++)
+        dst[k] = escape_unrolled(x, y + k*step, julia, 16);
+}
+
+/* Rows of the other formulas, one kernel each */
+static inline __attribute__((always_inline))
+void row_formula(uint8_t *dst, double x, double y, double step, int n, const int formula)
+{
+    for(int k = 0; k < n; k++)
+        dst[k] = escape_formula(x, y + k*step, formula);
+}
+
+static void row_multibrot3(uint8_t *dst, double x, double y, double step, int n, int formula)
+{
+    row_formula(dst, x, y, step, n, FRACTAL_MULTIBROT3);
+}
+
+static void row_multibrot4(uint8_t *dst, double x, double y, double step, int n, int formula)
+{
+    row_formula(dst, x, y, step, n, FRACTAL_MULTIBROT4);
+}
+
+static void row_burning_ship(uint8_t *dst, double x, double y, double step, int n, int formula)
+{
+    row_formula(dst, x, y, step, n, FRACTAL_BURNING_SHIP);
+}
+
+static void row_tricorn(uint8_t *dst, double x, double y, double step, int n, int formula)
+{
+    row_formula(dst, x, y, step, n, FRACTAL_TRICORN);
+}
+
+static void (*const formula_rows[FRACTAL_FORMULAS])(uint8_t*, double, double, double, int, int) = {
+    [FRACTAL_MULTIBROT3]   = row_multibrot3,
+    [FRACTAL_MULTIBROT4]   = row_multibrot4,
+    [FRACTAL_BURNING_SHIP] = row_burning_ship,
+    [FRACTAL_TRICORN]      = row_tricorn,
+};
+
+/* Only the tuned kernels take part in FRACTAL_AUTO, the rest are there
+   to be benchmarked */
+static const struct
+{
+    void (*row)(uint8_t *dst, double x, double y, double step, int n, int julia);
+    int tuned;
+} kernels[FRACTAL_KERNELS] = {
+    { row_scalar,   1 },
+    { row_pair,     1 },
+    { row_unroll2,  0 },
+    { row_unroll4,  1 },
+    { row_unroll8,  0 },
+    { row_unroll16, 0 },
+};
+
+const char *fractal_kernel_names[FRACTAL_KERNELS] = {
+    "scalar", "pair", "unroll2", "unroll4", "unroll8", "unroll16"
+};
+
+int fractal_kernel = FRACTAL_AUTO;
+uint32_t fractal_kernel_wins[FRACTAL_KERNELS];
+uint8_t fractal_choice[256 / FRACTAL_BLOCK][256 / FRACTAL_BLOCK];
+
+/* Rows each kernel is timed on per block when tuning */
+#define TUNE_ROWS 2
+
+
+
+/*
+ Adaptive supersampling
+
+ Each texel is computed once. A texel whose count differs from one of its
+ neighbours, in its block or just outside it, by more than EDGE_DELTA
+ sits on a band or set boundary and gets fractal_refine extra samples,
+ jittered inside the quadrants of the texel, and is written as the mean
+ of all its samples.
+ */
+
+#define BLOCK      FRACTAL_BLOCK
+#define EDGE_DELTA 16
+
+int fractal_refine = 4;
+uint32_t fractal_refined;
+
+uint8_t fractal_block[BLOCK][BLOCK];
+
+#ifdef FRACTAL_STATS
+uint16_t fractal_texel_iterations[256][256];
+uint8_t fractal_texel_exit[256][256];
+fractal_cell fractal_cells[256 / FRACTAL_STATS_CELL][256 / FRACTAL_STATS_CELL];
+
+void fractal_stats_clear()
+{
+    memset(fractal_texel_iterations, 0, sizeof(fractal_texel_iterations));
+    memset(fractal_texel_exit, 0, sizeof(fractal_texel_exit));
+    memset(fractal_cells, 0, sizeof(fractal_cells));
+}
+
+/* The first sample of every texel, straight from the row kernels */
+static void stats_block(int i0, int j0, int level)
+{
+    if(level)
+        return;
+
+    for(int li=0; li<BLOCK; li++)
+        for(int lj=0; lj<BLOCK; lj++)
+        {
+            int i = i0 + li, j = j0 + lj, n = fractal_block[li][lj];
+            fractal_cell *c = &fractal_cells[i / FRACTAL_STATS_CELL][j / FRACTAL_STATS_CELL];
+
+            fractal_texel_iterations[i][j] = n + 1;
+            fractal_texel_exit[i][j] = n == 255 ? FRACTAL_EXIT_MAXITER : FRACTAL_EXIT_BAILOUT;
+            c->iterations += n + 1;
+            if(n == 255)
+                c->maxiters++;
+            else
+                c->bailouts++;
+        }
+}
+
+/* One extra sample, n as returned by compute_sample() */
+static void stats_sample(int i, int j, int level, uint32_t n)
+{
+    if(level)
+        return;
+
+    fractal_texel_iterations[i][j] += n + 1;
+    fractal_cells[i / FRACTAL_STATS_CELL][j / FRACTAL_STATS_CELL].iterations += n + 1;
+}
+
+static void stats_refined(int i, int j, int level)
+{
+    if(!level)
+        fractal_cells[i / FRACTAL_STATS_CELL][j / FRACTAL_STATS_CELL].refined++;
+}
+#else
+#define stats_block(i0, j0, level)
+#define stats_sample(i, j, level, n)
+#define stats_refined(i, j, level)
+#endif
+
+static float jitter(int i, int j, int k)
+{
+    uint32_t h = (i * 73856093u) ^ (j * 19349663u) ^ (k * 83492791u);
+    return (float)((h >> 8) & 0xff) * (1.0f/1024) - 0.125f;
+}
+
+/* The block's counts with a one texel border from the neighbouring
+   blocks, so texels on the block's sides are judged like any other */
+static uint8_t bordered[BLOCK+2][BLOCK+2];
+
+static void border_block(int i0, int j0, int level, int formula)
+{
+    for(int li=0; li<BLOCK; li++)
+        for(int lj=0; lj<BLOCK; lj++)
+            bordered[li+1][lj+1] = fractal_block[li][lj];
+
+    for(int k=0; k<BLOCK; k++)
+    {
+        double u = level_coord(i0 + k, level), v = level_coord(j0 + k, level);
+
+        bordered[0][k+1]       = compute_sample(level_coord(i0 - 1, level), v, formula);
+        bordered[BLOCK+1][k+1] = compute_sample(level_coord(i0 + BLOCK, level), v, formula);
+        bordered[k+1][0]       = compute_sample(u, level_coord(j0 - 1, level), formula);
+        bordered[k+1][BLOCK+1] = compute_sample(u, level_coord(j0 + BLOCK, level), formula);
+    }
+}
+
+static int is_edge(int li, int lj)
+{
+    int n = bordered[li+1][lj+1];
+    int d = 0;
+
+    /* |n - m| > EDGE_DELTA with a single unsigned compare */
+    d |= (unsigned)(n - bordered[li][lj+1]   + EDGE_DELTA) > 2*EDGE_DELTA;
+    d |= (unsigned)(n - bordered[li+2][lj+1] + EDGE_DELTA) > 2*EDGE_DELTA;
+    d |= (unsigned)(n - bordered[li+1][lj]   + EDGE_DELTA) > 2*EDGE_DELTA;
+    d |= (unsigned)(n - bordered[li+1][lj+2] + EDGE_DELTA) > 2*EDGE_DELTA;
+
+    return d;
+}
+
+static void refine_block(int i0, int j0, int level, int formula)
+{
+    static uint8_t edge[BLOCK][BLOCK];
+
+    /* Decide on the single-sample counts before overwriting any of them */
+    border_block(i0, j0, level, formula);
+    for(int li=0; li<BLOCK; li++)
+        for(int lj=0; lj<BLOCK; lj++)
+            edge[li][lj] = is_edge(li, lj);
+
+    for(int li=0; li<BLOCK; li++)
+        for(int lj=0; lj<BLOCK; lj++)
+        {
+            int i = i0 + li, j = j0 + lj;
+            uint32_t sum;
+
+            if(!edge[li][lj])
+                continue;
+
+            sum = fractal_block[li][lj];
+            for(int k=0; k<fractal_refine; k++)
+            {
+                float dx = (k & 1 ? 0.25f : -0.25f) + jitter(i, j, 2*k);
+                float dy = (k & 2 ? 0.25f : -0.25f) + jitter(i, j, 2*k+1);
+
+                uint32_t n = compute_sample(level_coord(i + dx, level), level_coord(j + dy, level), formula);
+
+                stats_sample(i, j, level, n);
+                sum += n;
+            }
+
+            fractal_block[li][lj] = (2*sum + fractal_refine + 1) / (2*(fractal_refine + 1));
+            fractal_refined++;
+            stats_refined(i, j, level);
+        }
+}
+
+/* Compute the block of texels at (i0, j0) of the given level into
+   fractal_block, refining edges if enabled. With FRACTAL_AUTO the first
+   rows of a Mandelbrot or Julia block are computed by every kernel and
+   the fastest does the rest; other formulas have one kernel each. */
+void fractal_compute_block(int i0, int j0, int level, int formula)
+{
+    double y = level_coord(j0, level), step = level_step(level);
+    int kernel = fractal_kernel, li = 0;
+
+    if(formula > FRACTAL_JULIA)
+    {
+        for(; li < BLOCK; li++) {
+            formula_rows[formula](fractal_block[li], level_coord(i0 + li, level), y, step, BLOCK, formula);
+            upload_burst();
+        }
+
+        stats_block(i0, j0, level);
+        if(fractal_refine)
+            refine_block(i0, j0, level, formula);
+        return;
+    }
+
+    if(kernel == FRACTAL_AUTO)
+    {
+        uint32_t best = 0xFFFFFFFF;
+
+        for(int k = 0; k < FRACTAL_KERNELS; k++)
+        {
+            uint32_t t;
+
+            if(!kernels[k].tuned)
+                continue;
+
+            t = timer_ticks();
+
+            for(li = 0; li < TUNE_ROWS; li++)
+                kernels[k].row(fractal_block[li], level_coord(i0 + li, level), y, step, BLOCK, formula);
+
+            t = timer_ticks() - t;
+            if(t < best) {
+                best = t;
+                kernel = k;
+            }
+        }
+
+        fractal_kernel_wins[kernel]++;
+        if(level == 0 && (unsigned)i0 < 256 && (unsigned)j0 < 256)
+            fractal_choice[i0 / BLOCK][j0 / BLOCK] = kernel;
+    }
+
+    for(; li < BLOCK; li++) {
+        kernels[kernel].row(fractal_block[li], level_coord(i0 + li, level), y, step, BLOCK, formula);
+        upload_burst();
+    }
+
+    stats_block(i0, j0, level);
+    if(fractal_refine)
+        refine_block(i0, j0, level, formula);
+}
+
+/* Store fractal_block at (i0, j0) of a twiddled PAL8 texture, two texels
+   per 16-bit store. A block is contiguous in twiddled order, so with
+   i0 = j0 = 0 this also writes a standalone 32x32 tile. */
+void fractal_store_block(uint16_t *dst, int i0, int j0)
+{
+    for(int li=0; li<BLOCK; li++)
+        for(int lj=0; lj<BLOCK; lj+=2)
+            dst[twiddletab[i0+li]|(twiddletab[j0+lj]>>1)] = fractal_block[li][lj] | (fractal_block[li][lj+1]<<8);
+}
+
+/* Send fractal_block to (i0, j0) of a twiddled PAL8 texture the way
+   fractal_build() does, packed in a staging buffer and sent in 32 byte
+   bursts, for blocks computed one at a time. Returns once it's sent. */
+void fractal_upload_block(uint16_t *dst, int i0, int j0)
+{
+    upload_flush();
+
+    fractal_store_block((uint16_t*)staging[0], 0, 0);
+    pending_src = staging[0];
+    pending_dst = (uint32_t*)(dst + (twiddletab[i0] | twiddletab[j0]>>1));
+    pending_bursts = BLOCK*BLOCK / UPLOAD_BURST;
+
+    upload_flush();
+}
+
+/* Fill a 256x256 twiddled PAL8 texture block by block, so refinement
+   works on cached neighbours. Each block is packed into a cached staging
+   buffer and sent to dst in 32 byte bursts, one burst per row of the next
+   block computed, so the bus writes overlap the FPU work. */
+void fractal_build(uint16_t *dst, int formula)
+{
+    int buf = 0;
+
+    for(int i0=0; i0<256; i0+=BLOCK)
+        for(int j0=0; j0<256; j0+=BLOCK)
+        {
+            fractal_compute_block(i0, j0, 0, formula);
+
+            /* The other staging buffer is still being sent */
+            upload_flush();
+
+            fractal_store_block((uint16_t*)staging[buf], 0, 0);
+            pending_src = staging[buf];
+            pending_dst = (uint32_t*)(dst + (twiddletab[i0] | twiddletab[j0]>>1));
+            pending_bursts = BLOCK*BLOCK / UPLOAD_BURST;
+            buf ^= 1;
+        }
+
+    upload_flush();
+}
@@ -0,0 +1,81 @@
+#ifndef FRACTAL_H_INCLUDED
+#define FRACTAL_H_INCLUDED
+
+#include "dc_types.h"
+
+#define FRACTAL_BLOCK 32
+
+/* Iteration limit of every kernel, counts are 0..FRACTAL_MAX_ITER */
+#define FRACTAL_MAX_ITER 255
+
+/* Bump when any kernel's output changes, cached textures are keyed by it */
+#define FRACTAL_VERSION 2
+
+/* Formulas, each with its own kernel */
+#define FRACTAL_MANDELBROT   0
+#define FRACTAL_JULIA        1
+#define FRACTAL_MULTIBROT3   2
+#define FRACTAL_MULTIBROT4   3
+#define FRACTAL_BURNING_SHIP 4
+#define FRACTAL_TRICORN      5
+#define FRACTAL_FORMULAS     6
+
+/* Escape time kernels for Mandelbrot and Julia, FRACTAL_AUTO times them on every block */
+#define FRACTAL_KERNELS 6
+#define FRACTAL_AUTO    (-1)
+
+extern int twiddletab[1024];
+extern uint8_t fractal_block[FRACTAL_BLOCK][FRACTAL_BLOCK];
+
+/* Extra samples per edge texel, 0 turns adaptive supersampling off */
+extern int fractal_refine;
+extern uint32_t fractal_refined;
+
+extern const char *fractal_formula_names[FRACTAL_FORMULAS];
+
+extern int fractal_kernel;
+extern const char *fractal_kernel_names[FRACTAL_KERNELS];
+
+/* Tuning decisions: wins per kernel and the kernel chosen for each block
+   of the last level 0 texture built */
+extern uint32_t fractal_kernel_wins[FRACTAL_KERNELS];
+extern uint8_t fractal_choice[256 / FRACTAL_BLOCK][256 / FRACTAL_BLOCK];
+
+/* Copies n bytes, a multiple of 32, from cached RAM to VRAM; plain word
+   copies unless set to sq_cpy() */
+extern void *(*fractal_upload)(void *dest, const void *src, int n);
+
+#ifdef FRACTAL_STATS
+/* Cost instrumentation for host tools built with -DFRACTAL_STATS: every
+   level 0 block computed records, per texel, the loop iterations of all
+   its samples and how its first sample left the loop, with totals per
+   FRACTAL_STATS_CELL square. Unrolled kernels run a few iterations past
+   the bailout before replaying; those aren't counted. */
+#define FRACTAL_STATS_CELL   8
+#define FRACTAL_EXIT_BAILOUT 0  /* |z| left the bailout radius */
+#define FRACTAL_EXIT_MAXITER 1  /* no early out, all 256 iterations */
+
+typedef struct
+{
+    uint32_t iterations;
+    uint16_t bailouts, maxiters;    /* texels by exit of the first sample */
+    uint16_t refined;               /* texels given extra samples */
+} fractal_cell;
+
+extern uint16_t fractal_texel_iterations[256][256];
+extern uint8_t fractal_texel_exit[256][256];
+extern fractal_cell fractal_cells[256 / FRACTAL_STATS_CELL][256 / FRACTAL_STATS_CELL];
+
+void fractal_stats_clear();
+#endif
+
+void fractal_init();
+void fractal_view(int formula, double *re, double *im, double *scale);
+uint32_t compute_texture(int x, int y, int formula);
+uint32_t compute_sample(double x, double y, int formula);
+void fractal_compute_block(int i0, int j0, int level, int formula);
+void fractal_store_block(uint16_t *dst, int i0, int j0);
+void fractal_upload_block(uint16_t *dst, int i0, int j0);
+void fractal_build(uint16_t *dst, int formula);
+
+#endif /* FRACTAL_H_INCLUDED */
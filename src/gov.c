@@ -0,0 +1,118 @@
+#include "gov.h"
+
+
+
+/*
+ Governor
+ */
+
+gov_knobs gov;
+gov_stats gov_info;
+gov_sample gov_history[GOV_HISTORY];
+
+static gov_limits limit;
+static uint32_t hold;       /* frames left without changes */
+static uint32_t calm;       /* frames the average has been under 3/4 */
+static uint32_t recover;    /* calm frames needed to restore */
+static uint32_t since;      /* frames since a restore not yet undone */
+
+void gov_init(const gov_limits *limits)
+{
+    limit = *limits;
+
+    gov.slice = limit.max_slice;
+    gov.refine = limit.max_refine;
+    gov.lod_bias = 0;
+
+    gov_info.frames = gov_info.average = gov_info.over = 0;
+    gov_info.degrades = gov_info.restores = 0;
+    hold = calm = 0;
+    recover = since = GOV_RECOVER;
+}
+
+static int degrade()
+{
+    if(gov.slice > limit.min_slice)
+        gov.slice = gov.slice / 2 < limit.min_slice ? limit.min_slice : gov.slice / 2;
+    else if(gov.refine > 0)
+        gov.refine /= 2;
+    else if(gov.lod_bias < limit.max_lod_bias)
+        gov.lod_bias++;
+    else
+        return 0;
+
+    return 1;
+}
+
+static int restore(uint32_t high)
+{
+    if(gov.lod_bias > 0)
+        gov.lod_bias--;
+    else if(gov.refine < limit.max_refine)
+        gov.refine = !gov.refine ? 1 : 2*gov.refine > limit.max_refine ? limit.max_refine : 2*gov.refine;
+    else if(gov.slice < limit.max_slice)
+    {
+        uint32_t next = 2*gov.slice > limit.max_slice ? limit.max_slice : 2*gov.slice;
+
+        /* Busy jobs use all of the slice, so that much is added */
+        if(gov_info.average + next - gov.slice > high)
+            return 0;
+
+        gov.slice = next;
+    }
+    else
+        return 0;
+
+    return 1;
+}
+
+void gov_update(uint32_t cpu, uint32_t wait, uint32_t total)
+{
+    uint32_t high = limit.budget - limit.budget / 16;
+    uint32_t low = limit.budget / 4 * 3;
+    gov_sample *s = &gov_history[gov_info.frames % GOV_HISTORY];
+
+    s->cpu = cpu;
+    s->wait = wait;
+    s->total = total;
+
+    gov_info.average = gov_info.frames ? (7*gov_info.average + total) / 8 : total;
+    gov_info.frames++;
+    if(total > limit.budget)
+        gov_info.over++;
+
+    /* A restore that held doesn't count against the next one */
+    if(++since == GOV_RECOVER)
+        recover = GOV_RECOVER;
+
+    if(hold) {
+        hold--;
+        return;
+    }
+
+    if(total > limit.budget || gov_info.average > high)
+    {
+        calm = 0;
+        if(degrade()) {
+            gov_info.degrades++;
+            hold = GOV_SETTLE;
+
+            /* Undoing a restore, wait twice as long before the next */
+            if(since < GOV_RECOVER && recover < GOV_RECOVER << 3)
+                recover *= 2;
+            since = GOV_RECOVER;
+        }
+        return;
+    }
+
+    if(gov_info.average >= low) {
+        calm = 0;
+        return;
+    }
+
+    if(++calm >= recover && restore(high)) {
+        gov_info.restores++;
+        calm = since = 0;
+        hold = GOV_SETTLE;
+    }
+}
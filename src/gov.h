@@ -0,0 +1,68 @@
+#ifndef GOV_H_INCLUDED
+#define GOV_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Frame time governor
+
+  main() reports each frame's costs to gov_update(): CPU time from the
+  top of the loop to the end of submission, the wait from there to TA
+  done (jobs run meanwhile) and the whole frame. The governor smooths
+  the frame time and moves the knobs in gov one step at a time to keep
+  it under the budget:
+
+    degrade  background slice halves, then refinement samples halve,
+             then the LOD bias goes up a level
+    restore  the same in reverse
+
+  A frame over budget or a smoothed time above 15/16 of it degrades at
+  once; restoring waits until the smoothed time has stayed under 3/4 of
+  the budget for GOV_RECOVER frames, and a slice increase must also be
+  predicted to fit. Either is followed by GOV_SETTLE frames without
+  changes while the average catches up.
+*/
+
+#define GOV_SETTLE   8
+#define GOV_RECOVER  120
+#define GOV_HISTORY  256
+
+typedef struct
+{
+    uint32_t budget;        /* ticks per frame */
+    uint32_t min_slice;     /* background job ticks per frame */
+    uint32_t max_slice;
+    int max_refine;         /* fractal_refine at full quality */
+    int max_lod_bias;       /* levels below what faces want, 0 without LOD */
+} gov_limits;
+
+typedef struct
+{
+    uint32_t slice;
+    int refine;
+    int lod_bias;
+} gov_knobs;
+
+typedef struct
+{
+    uint32_t cpu, wait, total;
+} gov_sample;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t average;       /* smoothed frame ticks */
+    uint32_t over;          /* frames past the budget */
+    uint32_t degrades, restores;
+} gov_stats;
+
+extern gov_knobs gov;
+extern gov_stats gov_info;
+
+/* The last GOV_HISTORY frames, frame n at n % GOV_HISTORY */
+extern gov_sample gov_history[GOV_HISTORY];
+
+void gov_init(const gov_limits *limits);
+void gov_update(uint32_t cpu, uint32_t wait, uint32_t total);
+
+#endif /* GOV_H_INCLUDED */
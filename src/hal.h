@@ -0,0 +1,56 @@
+#ifndef HAL_H_INCLUDED
+#define HAL_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Hardware access
+
+  Every register in dc_registers.h is a HAL_REG(type, address), read
+  with hal_read(reg) and written with hal_write(reg, value). On the
+  console those are the same volatile accesses as before. Host builds
+  make a register its address and send each access to hal_read32() or
+  hal_write32() in a simulated register file, and dc_locations.h
+  points VRAM, palette RAM and TA_Area at host arrays. src/hal_host.c
+  implements that, plus a TA that counts packets and raises the end of
+  list interrupt in SB_ISTNRM, so main() runs headless on Linux.
+
+  Every hal_write() is recorded, even of the value the register holds.
+  STARTRENDER and TA_LIST_INIT read back 0, and SB_ISTNRM clears the
+  bits written.
+*/
+
+#ifdef __sh__
+
+#define HAL_REG(type, addr)  (*(volatile type*)(addr))
+#define hal_read(reg)        (reg)
+#define hal_write(reg, v)    ((reg) = (v))
+
+#define hal_init(argc, argv)
+#define hal_running()        1
+#define hal_frame_costs(cpu, wait, jobs)
+
+#else
+
+#define HAL_REG(type, addr)  ((uint32_t)(addr))
+#define hal_read(reg)        hal_read32(reg)
+#define hal_write(reg, v)    hal_write32(reg, v)
+
+#define HAL_VRAM_BYTES    0x800000
+#define HAL_PALETTE_BYTES 0x1000
+#define HAL_TA_BYTES      32
+
+extern uint8_t hal_vram[HAL_VRAM_BYTES], hal_vram64[HAL_VRAM_BYTES];
+extern uint8_t hal_palette[HAL_PALETTE_BYTES];
+extern uint8_t hal_ta_area[HAL_TA_BYTES];
+
+uint32_t hal_read32(uint32_t addr);
+void hal_write32(uint32_t addr, uint32_t value);
+void hal_init(int argc, char **argv);
+int hal_running();
+void hal_frame_costs(uint32_t cpu, uint32_t wait, uint32_t jobs);
+void *hal_sq_cpy(void *dest, const void *src, int n);
+
+#endif
+
+#endif /* HAL_H_INCLUDED */
@@ -0,0 +1,298 @@
+/*
+  Host backend of hal.h
+
+  Linked into host/headless, main.c built for Linux:
+
+    headless [-n frames] [-a ns] [-s] [-t trace.txt] [-o gov.trace]
+
+  Runs the frame loop for the given frames (default 600) against a
+  simulated register file and memory, then prints the time per frame,
+  TA packets (parameters), sprites and bytes per frame, packets per
+  second, and the register reads and writes per frame of each
+  register the loop touches. The TA takes ns per 32 bytes (default 100)
+  after the end of list before raising its interrupt, so the jobs that
+  run during the TA wait get some time. -s sends every quad as a strip
+  (draw_sprites = 0). -t writes every register write, one per line:
+
+    frame address name value
+
+  -o writes each frame's costs as host/govsim reads them, in
+  microseconds: the CPU time to the end of submission, the wait for TA
+  done and the time background jobs ran.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dc_registers.h"
+#include "draw.h"
+#include "timer.h"
+#include "vram.h"
+
+#define REG_SLOTS 1024      /* power of two */
+#define TA_DONE   0x08      /* SB_ISTNRM: end of opaque list */
+
+uint8_t hal_vram[HAL_VRAM_BYTES] __attribute__((aligned(32)));
+uint8_t hal_vram64[HAL_VRAM_BYTES] __attribute__((aligned(32)));
+uint8_t hal_palette[HAL_PALETTE_BYTES] __attribute__((aligned(32)));
+uint8_t hal_ta_area[HAL_TA_BYTES] __attribute__((aligned(32)));
+
+typedef struct
+{
+    uint32_t addr;
+    uint32_t value;
+    uint32_t reads;         /* in the frame loop */
+    uint32_t writes;
+    int used;
+} reg;
+
+static reg regs[REG_SLOTS];
+
+static int max_frames = 600, frames = -1;
+static uint32_t ta_ns = 100;
+static FILE *trace, *costs;
+
+static uint32_t list_packets, ta_done_at;
+static int ta_busy, in_sprites, continued;
+static uint32_t packets, globals, sprites, bursts, renders;
+static uint32_t loop_start;
+
+/* Names of the registers main.c and palette.c touch, for reports */
+#define NAME(r) { r, #r }
+
+static const struct
+{
+    uint32_t addr;
+    const char *name;
+} names[] = {
+    NAME(FB_BURSTCTRL), NAME(FB_R_CTRL), NAME(FB_R_SIZE), NAME(FB_R_SOF1),
+    NAME(FB_W_CTRL), NAME(FB_W_LINESTRIDE), NAME(FB_W_SOF1), NAME(FB_X_CLIP),
+    NAME(FB_Y_CLIP), NAME(FPU_CULL_VAL), NAME(FPU_PARAM_CFG),
+    NAME(FPU_PERP_VAL), NAME(FPU_SHAD_SCALE), NAME(HALF_OFFSET),
+    NAME(ISP_BACKGND_D), NAME(ISP_BACKGND_T), NAME(ISP_FEED_CFG),
+    NAME(PAL_RAM_CTRL), NAME(PARAM_BASE), NAME(PCTRA), NAME(PDTRA),
+    NAME(PT_ALPHA_REF), NAME(QACR0), NAME(QACR1), NAME(REGION_BASE),
+    NAME(SB_ISTNRM), NAME(SDRAM_ARB_CFG), NAME(SDRAM_CFG), NAME(SDRAM_REFRESH),
+    NAME(SOFTRESET), NAME(SPAN_SORT_CFG), NAME(SPG_CONTROL), NAME(SPG_HBLANK),
+    NAME(SPG_LOAD), NAME(SPG_VBLANK), NAME(SPG_VBLANK_INT), NAME(SPG_WIDTH),
+    NAME(STARTRENDER), NAME(TA_ALLOC_CTRL), NAME(TA_GLOB_TILE_CLIP),
+    NAME(TA_ISP_BASE), NAME(TA_ISP_LIMIT), NAME(TA_LIST_INIT), NAME(TA_OL_BASE),
+    NAME(TA_OL_LIMIT), NAME(TEXT_CONTROL), NAME(VO_BORDER_COL),
+    NAME(VO_CONTROL), NAME(VO_STARTX), NAME(VO_STARTY),
+};
+
+#define NAMES (int)(sizeof(names) / sizeof(names[0]))
+
+static reg *lookup(uint32_t addr)
+{
+    uint32_t h = (addr >> 2) * 2654435761u;
+
+    for(uint32_t k = 0; k < REG_SLOTS; k++)
+    {
+        reg *r = &regs[(h + k) & (REG_SLOTS - 1)];
+
+        if(!r->used) {
+            r->used = 1;
+            r->addr = addr;
+            return r;
+        }
+        if(r->addr == addr)
+            return r;
+    }
+
+    fprintf(stderr, "hal: register file full at %08x\n", addr);
+    exit(1);
+}
+
+static const char *name_of(uint32_t addr)
+{
+    for(int k = 0; k < NAMES; k++)
+        if(names[k].addr == addr)
+            return names[k].name;
+
+    return "?";
+}
+
+/* A write, with its side effects */
+void hal_write32(uint32_t addr, uint32_t v)
+{
+    reg *r = lookup(addr);
+
+    switch(addr)
+    {
+    case SB_ISTNRM:         /* write 1 to clear */
+        r->value &= ~v;
+        break;
+
+    case TA_LIST_INIT:
+        if(v & 0x80000000) {
+            list_packets = 0;
+            ta_busy = 0;
+        }
+        r->value = 0;
+        break;
+
+    case STARTRENDER:
+        renders++;
+        r->value = 0;
+        break;
+
+    default:
+        r->value = v;
+    }
+
+    if(frames >= 0)
+        r->writes++;
+
+    if(trace)
+        fprintf(trace, "%d %08x %s %08x\n", frames, addr, name_of(addr), v);
+}
+
+uint32_t hal_read32(uint32_t addr)
+{
+    reg *r = lookup(addr);
+
+    if(addr == SB_ISTNRM && ta_busy && (int32_t)(timer_ticks() - ta_done_at) >= 0) {
+        r->value |= TA_DONE;
+        ta_busy = 0;
+    }
+
+    if(frames >= 0)
+        r->reads++;
+
+    return r->value;
+}
+
+/* sq_cpy(): TA parameters are counted, the end of list starts the TA's
+   countdown; anything else is a copy into simulated memory. A vertex
+   after a sprite's global parameter is 64 bytes, its second half isn't
+   a parameter of its own */
+void *hal_sq_cpy(void *dest, const void *src, int n)
+{
+    const uint32_t *p = (const uint32_t*)src;
+
+    if((uint8_t*)dest < hal_ta_area || (uint8_t*)dest >= hal_ta_area + HAL_TA_BYTES)
+        return memcpy(dest, src, n);
+
+    for(; n >= 32; n -= 32, p += 8)
+    {
+        uint32_t type = p[0] >> 29;
+
+        list_packets++;
+        if(frames >= 0)
+            bursts++;
+
+        if(continued) {
+            continued = 0;
+            continue;
+        }
+
+        if(frames >= 0)
+            packets++;
+
+        if(type == 4 || type == 5) {
+            in_sprites = type == 5;
+            if(frames >= 0)
+                globals++;
+        }
+
+        if(type == 7 && in_sprites) {
+            continued = 1;
+            if(frames >= 0)
+                sprites++;
+        }
+
+        if(type == 0) {
+            in_sprites = 0;
+            ta_done_at = timer_ticks() + list_packets * ta_ns;
+            ta_busy = 1;
+        }
+    }
+
+    return dest;
+}
+
+void hal_init(int argc, char **argv)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc)
+            max_frames = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-a") && i + 1 < argc)
+            ta_ns = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-s"))
+            draw_sprites = 0;
+        else if(!strcmp(argv[i], "-t") && i + 1 < argc) {
+            if(!(trace = fopen(argv[++i], "w"))) {
+                perror(argv[i]);
+                exit(1);
+            }
+        }
+        else if(!strcmp(argv[i], "-o") && i + 1 < argc) {
+            if(!(costs = fopen(argv[++i], "w"))) {
+                perror(argv[i]);
+                exit(1);
+            }
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n frames] [-a ns] [-s] [-t trace.txt] [-o gov.trace]\n", argv[0]);
+            exit(1);
+        }
+    }
+}
+
+static void report()
+{
+    double t = (double)(timer_ticks() - loop_start) / TIMER_HZ;
+    uint32_t reads = 0, writes = 0;
+    vram_stats v;
+
+    for(int k = 0; k < REG_SLOTS; k++) {
+        reads += regs[k].reads;
+        writes += regs[k].writes;
+    }
+
+    printf("%d frames in %.2f s, %.3f ms per frame, %u renders\n", frames, t, t * 1e3 / frames, renders);
+    printf("TA: %.1f packets per frame (%.1f global parameters, %.1f sprites), %.0f bytes, %.0f packets/s\n",
+           (double)packets / frames, (double)globals / frames, (double)sprites / frames,
+           32.0 * bursts / frames, packets / t);
+    vram_report(&v);
+    printf("VRAM: %u used, %u padding, %u peak, %u free, %u in one range\n",
+           v.used, v.padding, v.peak, v.free, v.largest);
+    printf("registers: %.1f reads, %.1f writes per frame\n",
+           (double)reads / frames, (double)writes / frames);
+
+    for(int k = 0; k < REG_SLOTS; k++)
+    {
+        const reg *r = &regs[k];
+
+        if(r->reads || r->writes)
+            printf("  %-18s %08x %6.2f reads %6.2f writes\n", name_of(r->addr), r->addr,
+                   (double)r->reads / frames, (double)r->writes / frames);
+    }
+}
+
+void hal_frame_costs(uint32_t cpu, uint32_t wait, uint32_t jobs)
+{
+    if(costs)
+        fprintf(costs, "%.0f %.0f %.0f\n", cpu * 1e6 / TIMER_HZ, wait * 1e6 / TIMER_HZ, jobs * 1e6 / TIMER_HZ);
+}
+
+/* Called at the top of every frame */
+int hal_running()
+{
+    if(++frames == 0) {
+        loop_start = timer_ticks();
+        return 1;
+    }
+
+    if(frames < max_frames)
+        return 1;
+
+    report();
+    if(trace)
+        fclose(trace);
+    if(costs)
+        fclose(costs);
+    return 0;
+}
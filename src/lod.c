@@ -0,0 +1,288 @@
+#include "lod.h"
+#include "scene.h"
+#include "sched.h"
+#include "timer.h"
+
+
+
+/*
+ Level of detail
+ */
+
+lod_level lod_levels[FRACTAL_FORMULAS][LOD_LEVELS];
+lod_stats lod_info;
+int lod_bias;
+uint16_t *(*lod_alloc)(uint32_t bytes);
+
+static uint32_t frame;
+
+/* The arena, up to LOD_ARENA bytes, in granules of the smallest level. A level takes a run of
+   granules of its own size, aligned to it, so a freed level leaves room
+   for one of its size or smaller ones without splinters */
+#define GRANULE  (32*32)
+#define GRANULES (LOD_ARENA / GRANULE)
+
+static uint16_t *arena;
+static uint8_t taken[GRANULES];
+static int granules;
+
+static int blocks_of(const lod_level *l)
+{
+    return (l->size / FRACTAL_BLOCK) * (l->size / FRACTAL_BLOCK);
+}
+
+int lod_ready(const lod_level *l)
+{
+    return l->texels && l->blocks == blocks_of(l);
+}
+
+/* TA_TSP_U_* | TA_TSP_V_* of a square level: 0 is 8 texels, 7 is 1024 */
+uint32_t lod_size_bits(const lod_level *l)
+{
+    int k = 0;
+
+    while((8 << k) < l->size)
+        k++;
+
+    return k << 3 | k;
+}
+
+void lod_init(uint32_t bytes)
+{
+    for(int f = 0; f < FRACTAL_FORMULAS; f++)
+        for(int k = 0; k < LOD_LEVELS; k++) {
+            int level = LOD_MIN_LEVEL + k;
+
+            lod_levels[f][k].texels = 0;
+            lod_levels[f][k].size = level >= 0 ? 256 << level : 256 >> -level;
+            lod_levels[f][k].blocks = 0;
+            lod_levels[f][k].refine = 0;
+            lod_levels[f][k].wanted = 0;
+            lod_levels[f][k].drawn = 0;
+        }
+
+    arena = lod_alloc(bytes);
+    granules = bytes / GRANULE;
+    for(int g = 0; g < GRANULES; g++)
+        taken[g] = 0;
+
+    frame = 0;
+}
+
+/* The frame a level was last wanted or drawn in */
+static uint32_t last_used(const lod_level *l)
+{
+    return l->wanted > l->drawn ? l->wanted : l->drawn;
+}
+
+static void release(lod_level *l)
+{
+    uint32_t bytes = l->size * l->size;
+    int g = (l->texels - arena) * 2 / GRANULE;
+
+    for(uint32_t n = 0; n < bytes / GRANULE; n++)
+        taken[g + n] = 0;
+
+    l->texels = 0;
+    l->blocks = 0;
+    lod_info.vram -= bytes;
+    lod_info.freed++;
+}
+
+/* Whether a level can go: not a 32x32 one, and not drawn in the frame
+   the TA may still be rendering */
+static int evictable(const lod_level *l)
+{
+    return l->texels && l->size > 32 && l->drawn + 1 < frame;
+}
+
+void lod_frame_begin()
+{
+    frame++;
+
+    for(int f = 0; f < FRACTAL_FORMULAS; f++)
+        for(int k = 0; k < LOD_LEVELS; k++) {
+            lod_level *l = &lod_levels[f][k];
+
+            if(evictable(l) && last_used(l) + LOD_KEEP <= frame)
+                release(l);
+        }
+}
+
+/* Compute the next block of a level, returns 1 once it's complete */
+static int build_block(int formula, int k)
+{
+    lod_level *l = &lod_levels[formula][k];
+    int per_row = l->size / FRACTAL_BLOCK;
+    int i0 = l->blocks / per_row * FRACTAL_BLOCK;
+    int j0 = l->blocks % per_row * FRACTAL_BLOCK;
+    uint32_t t = timer_ticks();
+    int refine = fractal_refine;
+
+    /* Every block of a level gets the same samples */
+    if(!l->blocks)
+        l->refine = refine;
+
+    fractal_refine = l->refine;
+    fractal_compute_block(i0, j0, LOD_MIN_LEVEL + k, formula);
+    fractal_refine = refine;
+    fractal_upload_block(l->texels, i0, j0);
+
+    l->blocks++;
+    lod_info.blocks++;
+    lod_info.ticks += timer_ticks() - t;
+
+    return l->blocks == blocks_of(l);
+}
+
+/* First free run of the level's size in the arena, 0 if there's none */
+static uint16_t *place(uint32_t bytes)
+{
+    int run = bytes / GRANULE, n;
+
+    for(int g = 0; arena && g + run <= granules; g += run)
+    {
+        for(n = 0; n < run && !taken[g + n]; n++)
+            ;
+
+        if(n == run) {
+            for(n = 0; n < run; n++)
+                taken[g + n] = 1;
+            return arena + g * GRANULE / 2;
+        }
+    }
+
+    return 0;
+}
+
+/* Room for a level, freeing the least recently used others until it
+   fits */
+static int allocate(lod_level *l)
+{
+    uint32_t bytes = l->size * l->size;
+
+    if(l->texels)
+        return 1;
+
+    while(!(l->texels = place(bytes)))
+    {
+        lod_level *oldest = 0;
+
+        for(int f = 0; f < FRACTAL_FORMULAS; f++)
+            for(int k = 0; k < LOD_LEVELS; k++) {
+                lod_level *o = &lod_levels[f][k];
+
+                if(o != l && evictable(o) && (!oldest || last_used(o) < last_used(oldest)))
+                    oldest = o;
+            }
+
+        if(!oldest || last_used(oldest) >= frame)
+            return 0;
+
+        release(oldest);
+    }
+
+    lod_info.vram += bytes;
+    if(lod_info.vram > lod_info.peak)
+        lod_info.peak = lod_info.vram;
+
+    return 1;
+}
+
+/* Twice the signed area of the quad p1 p2 p4 p3, the strip's outline */
+static float area2(const float *p1, const float *p2, const float *p3, const float *p4)
+{
+    return (p1[0] - p4[0]) * (p2[1] - p3[1]) - (p2[0] - p3[0]) * (p1[1] - p4[1]);
+}
+
+static int off_screen(const float *p1, const float *p2, const float *p3, const float *p4)
+{
+    const float *p[4] = { p1, p2, p3, p4 };
+    int left = 1, right = 1, above = 1, below = 1;
+
+    for(int k = 0; k < 4; k++) {
+        left &= p[k][0] < 0;
+        right &= p[k][0] >= WIDTH;
+        above &= p[k][1] < 0;
+        below &= p[k][1] >= HEIGHT;
+    }
+
+    return left | right | above | below;
+}
+
+const lod_level *lod_face(int formula, const float *p1, const float *p2, const float *p3, const float *p4)
+{
+    lod_level *levels = lod_levels[formula];
+    float area = area2(p1, p2, p3, p4) * 0.5f;
+    int want = 0, k;
+
+    /* Facing away, the TA culls it (TA_ISP_TSP_CULL_IF_NEG) */
+    if(area <= 0)
+        return 0;
+
+    if(off_screen(p1, p2, p3, p4))
+        area = 0;
+
+    while(want < LOD_LEVELS - 1 && (float)levels[want].size * levels[want].size < area)
+        want++;
+
+    want = want > lod_bias ? want - lod_bias : 0;
+
+    lod_info.faces++;
+    levels[want].wanted = frame;
+    allocate(&levels[want]);
+
+    /* Nearest built level, finer first */
+    for(k = want; k < LOD_LEVELS && !lod_ready(&levels[k]); k++)
+        ;
+
+    if(k == LOD_LEVELS)
+    {
+        if(want > 0)
+            lod_info.coarse++;
+
+        for(k = want - 1; k >= 0 && !lod_ready(&levels[k]); k--)
+            ;
+    }
+
+    /* Nothing yet: the smallest level now */
+    if(k < 0)
+    {
+        if(!allocate(&levels[0]))
+            return 0;
+
+        while(!build_block(formula, 0))
+            ;
+        k = 0;
+    }
+
+    levels[k].drawn = frame;
+    return &levels[k];
+}
+
+/* A block of the most recently wanted unfinished level, smallest first */
+int lod_job(void *arg)
+{
+    int best_f = -1, best_k = 0;
+
+    for(int f = 0; f < FRACTAL_FORMULAS; f++)
+        for(int k = 0; k < LOD_LEVELS; k++)
+        {
+            const lod_level *l = &lod_levels[f][k];
+
+            if(!l->texels || lod_ready(l))
+                continue;
+
+            if(best_f < 0 || l->wanted > lod_levels[best_f][best_k].wanted
+                || (l->wanted == lod_levels[best_f][best_k].wanted && k < best_k)) {
+                best_f = f;
+                best_k = k;
+            }
+        }
+
+    if(best_f < 0)
+        return SCHED_IDLE;
+
+    build_block(best_f, best_k);
+    return SCHED_MORE;
+}
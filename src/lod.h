@@ -0,0 +1,85 @@
+#ifndef LOD_H_INCLUDED
+#define LOD_H_INCLUDED
+
+#include "dc_types.h"
+#include "fractal.h"
+
+/*
+  Texture level of detail
+
+  Each formula's texture can exist at LOD_LEVELS resolutions, 32x32 up
+  to 1024x1024: levels LOD_MIN_LEVEL..LOD_MAX_LEVEL of
+  fractal_compute_block(), 256 << level texels a side, all of the same
+  view. lod_face() takes a face's screen corners and returns the level
+  to draw it with: the smallest one that puts a texel on every pixel of
+  the face's area if that is built, otherwise the nearest built one,
+  finer levels first, and lod_bias levels smaller than that when the
+  governor asks for less. A face entirely off screen wants the smallest,
+  and one facing away, which the TA culls, gets 0 and wants nothing.
+
+  Levels live in one arena of up to LOD_ARENA bytes, taken through
+  lod_alloc by lod_init(). A level gets an aligned slot of its own size the first
+  time a face wants it. lod_job() then computes it a block per step
+  in the background with the fractal_refine of its first block, and it
+  is used once all its blocks are done. The
+  most recently wanted levels go first, and smaller levels before
+  larger. A formula with no level built yet gets its 32x32 level, a
+  single block, on the spot; a face facing the screen gets 0 only if
+  there's no memory even for that.
+
+  A level no face has wanted or been drawn with for LOD_KEEP frames is
+  freed, and when the arena is full the least recently used level goes
+  to make room. The 32x32 levels stay, and a level drawn in the last
+  frame stays, since the TA renders that frame while the next one is
+  built. No more than the arena is ever resident; a face whose level
+  doesn't fit is drawn with the nearest one that does.
+*/
+
+#define LOD_MIN_LEVEL (-3)
+#define LOD_MAX_LEVEL 2
+#define LOD_LEVELS    (LOD_MAX_LEVEL - LOD_MIN_LEVEL + 1)
+
+/* Bytes of levels resident at once: a 1024x1024 level and the rest */
+#define LOD_ARENA     (2 << 20)
+
+/* Frames a level stays unused before it's freed */
+#define LOD_KEEP      120
+
+typedef struct
+{
+    uint16_t *texels;   /* twiddled PAL8, 0 until allocated */
+    int size;           /* texels a side */
+    int blocks;         /* computed so far, of (size / FRACTAL_BLOCK)^2 */
+    int refine;         /* fractal_refine of its blocks */
+    uint32_t wanted;    /* frame a face last wanted it, 0 never */
+    uint32_t drawn;     /* frame a face was last drawn with it, 0 never */
+} lod_level;
+
+typedef struct
+{
+    uint32_t vram;      /* bytes of levels resident */
+    uint32_t peak;      /* most of them at once */
+    uint32_t freed;     /* levels freed, unused or to make room */
+    uint32_t blocks;    /* blocks computed */
+    uint32_t ticks;     /* spent computing them */
+    uint32_t faces;     /* lod_face() calls for faces facing the screen */
+    uint32_t coarse;    /* faces drawn coarser than they wanted */
+} lod_stats;
+
+extern lod_level lod_levels[FRACTAL_FORMULAS][LOD_LEVELS];
+extern lod_stats lod_info;
+
+/* Levels below the one a face wants, from gov.lod_bias */
+extern int lod_bias;
+
+/* Memory for the arena of levels, 0 if there's none */
+extern uint16_t *(*lod_alloc)(uint32_t bytes);
+
+void lod_init(uint32_t bytes);
+void lod_frame_begin();
+const lod_level *lod_face(int formula, const float *p1, const float *p2, const float *p3, const float *p4);
+int lod_ready(const lod_level *l);
+uint32_t lod_size_bits(const lod_level *l);
+int lod_job(void *arg);
+
+#endif /* LOD_H_INCLUDED */
@@ -0,0 +1,51 @@
+/*
+  C versions of the routines in math.s, for host builds.
+
+  xmtrx mirrors the XMTRX register bank: xmtrx[c] is column c, so
+  xmtrx[c][r] is XF(r + 4*c) and ftrv computes sum over c of
+  xmtrx[c][r] * v[c].
+ */
+#include "math.h"
+
+static float xmtrx[4][4];
+
+static void ftrv(const float *v, float *out)
+{
+    for(int r = 0; r < 4; r++)
+        out[r] = xmtrx[0][r]*v[0] + xmtrx[1][r]*v[1] + xmtrx[2][r]*v[2] + xmtrx[3][r]*v[3];
+}
+
+void clear_matrix()
+{
+    for(int c = 0; c < 4; c++)
+        for(int r = 0; r < 4; r++)
+            xmtrx[c][r] = c == r;
+}
+
+void apply_matrix(float (*matrix)[4][4])
+{
+    float result[4][4];
+
+    for(int c = 0; c < 4; c++)
+        ftrv((*matrix)[c], result[c]);
+
+    for(int c = 0; c < 4; c++)
+        for(int r = 0; r < 4; r++)
+            xmtrx[c][r] = result[c][r];
+}
+
+void transform_coords(float (*src)[3], float (*dest)[3], int n)
+{
+    while(n--)
+    {
+        float v[4] = { (*src)[0], (*src)[1], (*src)[2], 1.0f };
+        float o[4];
+
+        ftrv(v, o);
+        (*dest)[0] = o[0] / o[3];
+        (*dest)[1] = o[1] / o[3];
+        (*dest)[2] = o[2] / o[3];
+        src++;
+        dest++;
+    }
+}
@@ -0,0 +1,116 @@
+#include "palette.h"
+#include "dc_registers.h"
+#include "dc_locations.h"
+
+
+
+/*
+ PALETTE
+ */
+
+/* Entries 0 (escapes on the first step) and 255 (inside the set) are kept
+   out of the colour cycle so the background and the set stay put */
+#define CYCLE_FIRST 1
+#define CYCLE_LEN   254
+
+static const pal_key red_keys[] = {
+    {   0, 0xff000000 }, {   1, 0xff3c3c3c }, {  32, 0xffff0000 },
+    {  64, 0xffffff00 }, {  96, 0xffffffff }, { 160, 0xffff7900 },
+    { 192, 0xffff0000 }, { 224, 0xffa20000 }, { 255, 0xff3c3c3c },
+};
+
+static const pal_key blue_keys[] = {
+    {   0, 0xff000000 }, {   1, 0xff000000 }, {  32, 0xff0000cb },
+    {  64, 0xff00cbff }, {  96, 0xffffffff }, { 144, 0xff00ffff },
+    { 192, 0xff0000ff }, { 255, 0xff000000 },
+};
+
+static const pal_key purplish_keys[] = {
+    {   0, 0xff000000 }, {   1, 0xff9208e7 }, {  32, 0xffe30892 },
+    {  64, 0xffff4d34 }, {  96, 0xffcfae00 }, { 136, 0xff59ff28 },
+    { 192, 0xff00b2cf }, { 224, 0xff304dff }, { 255, 0xff8e08e7 },
+};
+
+uint32_t pal_banks[PAL_BANKS][256];
+
+
+/* Blend two ARGB colours, t = 0..256. Two channels are done per multiply. */
+static uint32_t lerp_argb(uint32_t a, uint32_t b, uint32_t t)
+{
+    uint32_t s  = 256 - t;
+    uint32_t rb = ((a & 0x00ff00ff) * s + (b & 0x00ff00ff) * t) >> 8;
+    uint32_t ag = ((a >> 8) & 0x00ff00ff) * s + ((b >> 8) & 0x00ff00ff) * t;
+
+    return (rb & 0x00ff00ff) | (ag & 0xff00ff00);
+}
+
+/* Fill a 256 entry bank from keyframes sorted by index, the first at 0 and
+   the last at 255. Entries between two keys are linearly interpolated. */
+void pal_gradient(uint32_t *bank, const pal_key *keys, int n)
+{
+    for(int k = 0; k < n-1; k++)
+    {
+        uint32_t from = keys[k].index;
+        uint32_t span = keys[k+1].index - from;
+
+        for(uint32_t i = 0; i < span; i++)
+            bank[from + i] = lerp_argb(keys[k].argb, keys[k+1].argb, (i << 8) / span);
+    }
+
+    bank[keys[n-1].index] = keys[n-1].argb;
+}
+
+/* Copy a bank to palette RAM with the cycling range rotated by shift */
+void pal_rotate(volatile uint32_t *dst, const uint32_t *src, int shift)
+{
+    int s = shift % CYCLE_LEN;
+    int n;
+
+    if(s < 0)
+        s += CYCLE_LEN;
+
+    src += CYCLE_FIRST;
+    dst += CYCLE_FIRST;
+
+    for(n = 0; n < CYCLE_LEN - s; n++)
+        dst[n] = src[n + s];
+
+    for(; n < CYCLE_LEN; n++)
+        dst[n] = src[n + s - CYCLE_LEN];
+}
+
+/* Write the blend of two banks to palette RAM, t = 0..256 */
+void pal_crossfade(volatile uint32_t *dst, const uint32_t *a, const uint32_t *b, int t)
+{
+    for(int n = 0; n < 256; n++)
+        dst[n] = lerp_argb(a[n], b[n], t);
+}
+
+void pal_init()
+{
+    volatile uint32_t (*palette)[4][256] = (volatile uint32_t (*)[4][256])PAL_RAM_BASE;
+
+    pal_gradient(pal_banks[0], red_keys,      sizeof(red_keys) / sizeof(pal_key));
+    pal_gradient(pal_banks[1], blue_keys,     sizeof(blue_keys) / sizeof(pal_key));
+    pal_gradient(pal_banks[2], purplish_keys, sizeof(purplish_keys) / sizeof(pal_key));
+
+    hal_write(PAL_RAM_CTRL, 0x3); // looks like ARGB8888
+
+    for(int b = 0; b < PAL_BANKS; b++)
+        for(int n = 0; n < 256; n++)
+            (*palette)[b][n] = pal_banks[b][n];
+}
+
+/* Animate palette RAM for the given frame. Must run while the TSP isn't
+   reading the palette, i.e. after the TA-done wait and before STARTRENDER. */
+void pal_update(int frame)
+{
+    volatile uint32_t (*palette)[4][256] = (volatile uint32_t (*)[4][256])PAL_RAM_BASE;
+    int t = frame & 511;
+
+    pal_rotate((*palette)[0], pal_banks[0],  frame);
+    pal_rotate((*palette)[1], pal_banks[1], -frame);
+
+    /* Bank 2 breathes between purple and red */
+    pal_crossfade((*palette)[2], pal_banks[2], pal_banks[0], t < 256 ? t : 512 - t);
+}
@@ -0,0 +1,24 @@
+#ifndef PALETTE_H_INCLUDED
+#define PALETTE_H_INCLUDED
+
+#include "dc_types.h"
+
+/* A gradient keyframe: palette index and the ARGB colour it takes */
+typedef struct
+{
+    uint32_t index;
+    uint32_t argb;
+} pal_key;
+
+#define PAL_BANKS 3
+
+extern uint32_t pal_banks[PAL_BANKS][256];
+
+void pal_gradient(uint32_t *bank, const pal_key *keys, int n);
+void pal_rotate(volatile uint32_t *dst, const uint32_t *src, int shift);
+void pal_crossfade(volatile uint32_t *dst, const uint32_t *a, const uint32_t *b, int t);
+
+void pal_init();
+void pal_update(int frame);
+
+#endif /* PALETTE_H_INCLUDED */
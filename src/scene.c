@@ -0,0 +1,320 @@
+#include "math.h"
+#include "dc_ta_instructions.h"
+#include "scene.h"
+#include "vram.h"
+#include "draw.h"
+#include "lod.h"
+#include "vtex.h"
+
+
+
+/*
+ MATH 
+ */
+
+#define F_PI 3.1415926f
+
+#define XCENTER (WIDTH / 2.0)
+#define YCENTER (HEIGHT / 2.0)
+
+#define COT_FOVY_2 1.73 /* cot(FOVy / 2) */
+#define ZNEAR 1.0
+#define ZFAR  100.0
+
+#define ZOFFS 5.0
+
+float screenview_matrix[4][4] = {
+  { YCENTER,     0.0,   0.0,   0.0 },
+  {     0.0, YCENTER,   0.0,   0.0 },
+  {     0.0,     0.0,   1.0 ,  0.0 },
+  { XCENTER, YCENTER,   0.0,   1.0 },
+};
+
+float projection_matrix[4][4] = {
+  { COT_FOVY_2,         0.0,                        0.0,   0.0 },
+  {        0.0,  COT_FOVY_2,                        0.0,   0.0 },
+  {        0.0,         0.0,  (ZFAR+ZNEAR)/(ZNEAR-ZFAR),  -1.0 },
+  {        0.0,         0.0,  2*ZFAR*ZNEAR/(ZNEAR-ZFAR),   1.0 },
+};
+
+float translation_matrix[4][4] = {
+  { 1.0,   0.0,    0.0,   0.0 },
+  { 0.0,   1.0,    0.0,   0.0 },
+  { 0.0,   0.0,    1.0,   0.0 },
+  { 0.0,   0.0,  ZOFFS,   1.0 },
+};
+
+
+#ifdef __sh__
+#define __fsin(x) \
+    ({ float __value, __arg = (x), __scale = 10430.37835; \
+        __asm__("fmul   %2,%1\n\t" \
+                "ftrc   %1,fpul\n\t" \
+                "fsca   fpul,dr0\n\t" \
+                "fmov   fr0,%0" \
+                : "=f" (__value), "+&f" (__scale) \
+                : "f" (__arg) \
+                : "fpul", "fr0", "fr1"); \
+        __value; })
+
+#define __fcos(x) \
+    ({ float __value, __arg = (x), __scale = 10430.37835; \
+        __asm__("fmul   %2,%1\n\t" \
+                "ftrc   %1,fpul\n\t" \
+                "fsca   fpul,dr0\n\t" \
+                "fmov   fr1,%0" \
+                : "=f" (__value), "+&f" (__scale) \
+                : "f" (__arg) \
+                : "fpul", "fr0", "fr1"); \
+        __value; })
+#else
+#define __fsin(x) __builtin_sinf(x)
+#define __fcos(x) __builtin_cosf(x)
+#endif
+
+float fsin(float r) {
+    return __fsin(r);
+}
+
+float fcos(float r) {
+    return __fcos(r);
+}
+
+void rotate_x(int n)
+{
+    float matrix[4][4] = {
+    { 1.0, 0.0, 0.0, 0.0 },
+    { 0.0, 1.0, 0.0, 0.0 },
+    { 0.0, 0.0, 1.0, 0.0 },
+    { 0.0, 0.0, 0.0, 1.0 },
+    };
+
+    matrix[1][1] = matrix[2][2] = fcos((float)n * F_PI / 180.0f);
+    matrix[1][2] = -(matrix[2][1] = fsin((float)n * F_PI / 180.0f));
+    apply_matrix(&matrix);
+}
+
+void rotate_y(int n)
+{
+    float matrix[4][4] = {
+    { 1.0, 0.0, 0.0, 0.0 },
+    { 0.0, 1.0, 0.0, 0.0 },
+    { 0.0, 0.0, 1.0, 0.0 },
+    { 0.0, 0.0, 0.0, 1.0 },
+    };
+
+    matrix[0][0] = matrix[2][2] = fcos((float)n * F_PI / 180.0f);
+    matrix[2][0] = -(matrix[0][2] = fsin((float)n * F_PI / 180.0f));
+    apply_matrix(&matrix);
+}
+
+void rotate_z(int n)
+{
+    float matrix[4][4] = {
+    { 1.0, 0.0, 0.0, 0.0 },
+    { 0.0, 1.0, 0.0, 0.0 },
+    { 0.0, 0.0, 1.0, 0.0 },
+    { 0.0, 0.0, 0.0, 1.0 },
+    };
+
+    matrix[0][0] = matrix[1][1] =  fcos((float)n * F_PI / 180.0f);
+    matrix[0][1] = -(matrix[1][0] = fsin((float)n * F_PI / 180.0f));
+    apply_matrix(&matrix);
+}
+
+
+
+
+
+/*
+ Mandelbrot
+ */
+
+/* Formula shown on each face, see fractal.h. The VTEX build only pans
+   Mandelbrot and Julia */
+int face_formula[6] = {
+    FRACTAL_MANDELBROT, FRACTAL_MANDELBROT, FRACTAL_MANDELBROT,
+    FRACTAL_JULIA,      FRACTAL_JULIA,      FRACTAL_JULIA,
+};
+
+/* One texture per formula in use. They share atlases of up to four
+   256x256 slots stacked in V, so faces differing only in formula share
+   a global parameter. Bilinear filtering at a slot's top and bottom
+   edges would read the neighbouring slot instead of wrapping, so faces
+   keep half a texel inside the band, rounded inward to the 16 bits of
+   a sprite's UVs. */
+#define ATLAS_SLOTS 4
+
+uint16_t *tex[FRACTAL_FORMULAS];
+int formulas[FRACTAL_FORMULAS], formula_count;
+
+static struct
+{
+    uint32_t offset;    /* of the atlas */
+    uint32_t size;      /* TA_TSP_U_256 | TA_TSP_V_* of the atlas */
+    float v0, v1;       /* the slot's band */
+    float in0, in1;     /* the band less half a texel each side */
+} slot[FRACTAL_FORMULAS];
+
+/* The nearest UV at or above, at or below f that packs in 16 bits */
+static float uv_up(float f)
+{
+    union { float f; uint32_t w; } a = { f };
+
+    if(a.w & 0xFFFF)
+        a.w = (a.w | 0xFFFF) + 1;
+    return a.f;
+}
+
+static float uv_down(float f)
+{
+    union { float f; uint32_t w; } a = { f };
+
+    a.w &= 0xFFFF0000;
+    return a.f;
+}
+
+void atlas_init()
+{
+    static const uint32_t v_size[ATLAS_SLOTS + 1] = { 0, TA_TSP_V_256, TA_TSP_V_512, TA_TSP_V_1024, TA_TSP_V_1024 };
+    static const int rows[ATLAS_SLOTS + 1] = { 0, 1, 2, 4, 4 };
+
+    for(int f = 0; f < FRACTAL_FORMULAS; f++)
+        for(int k = 0; k < 6; k++)
+            if(face_formula[k] == f) {
+                formulas[formula_count++] = f;
+                break;
+            }
+
+    for(int first = 0; first < formula_count; first += ATLAS_SLOTS)
+    {
+        int n = formula_count - first < ATLAS_SLOTS ? formula_count - first : ATLAS_SLOTS;
+        uint32_t offset = vram_alloc(VRAM_TEX64, 256*256 * rows[n], 32, "atlas");
+        uint16_t *base = (uint16_t*)vram64(offset);
+
+        for(int k = 0; k < n; k++)
+        {
+            int f = formulas[first + k];
+
+            tex[f] = base + k * 256*256/2;
+            slot[f].offset = offset;
+            slot[f].size = TA_TSP_U_256 | v_size[n];
+            slot[f].v0 = (float)k / rows[n];
+            slot[f].v1 = (float)(k + 1) / rows[n];
+            slot[f].in0 = uv_up(slot[f].v0 + 0.5f / (256 * rows[n]));
+            slot[f].in1 = uv_down(slot[f].v1 - 0.5f / (256 * rows[n]));
+        }
+    }
+}
+
+#ifdef LOD
+/* The levels of detail's arena comes from VRAM */
+uint16_t *lod_vram(uint32_t bytes)
+{
+    uint32_t offset = vram_alloc(VRAM_TEX64, bytes, 32, "lod");
+
+    return offset == VRAM_FAIL ? 0 : (uint16_t*)vram64(offset);
+}
+
+void draw_face(float *p1, float *p2, float *p3, float *p4, int face, int pal)
+{
+  const lod_level *l = lod_face(face_formula[face], p1, p2, p3, p4);
+  uint32_t offset;
+
+  if(!l)
+    return;
+
+  offset = (uint8_t*)l->texels - (uint8_t*)vram64(0);
+  draw_quad(p1, p2, p3, p4, lod_size_bits(l), draw_texture_word(offset, pal), 0.0f, 1.0f, 0.0f, 1.0f);
+}
+#elif defined(VTEX)
+/*
+ Scripted camera for the virtual texture, in the format of host/vtex.path:
+ frames, pan per frame in texels of the current level, zoom afterwards
+ */
+const int camera_path[][4] = {
+  {  60,  0,  0,  0 }, { 120,  1,  0,  0 }, {   1,  0,  0,  1 },
+  { 120,  0,  1,  0 }, {   1,  0,  0,  1 }, { 120, -1,  1,  0 },
+  {   1,  0,  0,  1 }, { 180,  1, -1,  0 }, {   1,  0,  0, -3 },
+};
+
+vt_camera camera = { 128.0, 128.0, 0 };
+
+void camera_update()
+{
+    static int segment, frame;
+
+    if(frame == camera_path[segment][0]) {
+        vtex_zoom(&camera, camera_path[segment][3]);
+        segment = (segment + 1) % (sizeof(camera_path) / sizeof(camera_path[0]));
+        frame = 0;
+    }
+
+    vtex_pan(&camera, camera_path[segment][1], camera_path[segment][2]);
+    frame++;
+}
+
+/* The camera's window of the face's slot */
+void draw_face(float *p1, float *p2, float *p3, float *p4, int face, int pal)
+{
+  int f = face_formula[face];
+  float u0, v0, w = (float)VT_WINDOW / 256, h = slot[f].v1 - slot[f].v0, top, bottom;
+
+  vtex_window(&camera, &u0, &v0);
+  top = slot[f].v0 + v0 * h;
+  bottom = slot[f].v0 + (v0 + w) * h;
+  draw_quad(p1, p2, p3, p4, slot[f].size, draw_texture_word(slot[f].offset, pal), u0, u0 + w,
+            top > slot[f].in0 ? top : slot[f].in0, bottom < slot[f].in1 ? bottom : slot[f].in1);
+}
+#else
+void draw_face(float *p1, float *p2, float *p3, float *p4, int face, int pal)
+{
+  int f = face_formula[face];
+
+  draw_quad(p1, p2, p3, p4, slot[f].size, draw_texture_word(slot[f].offset, pal), 0.0f, 1.0f, slot[f].in0, slot[f].in1);
+}
+#endif
+
+
+
+/*
+ Cube
+ */
+
+float coords[8][3] = {
+  { -1.0, -1.0, -1.0 },
+  {  1.0, -1.0, -1.0 },
+  { -1.0,  1.0, -1.0 },
+  {  1.0,  1.0, -1.0 },
+  { -1.0, -1.0,  1.0 },
+  {  1.0, -1.0,  1.0 },
+  { -1.0,  1.0,  1.0 },
+  {  1.0,  1.0,  1.0 },
+};
+
+float trans_coords[8][3];
+
+/* Place the cube for the given frame, leaving its corners on screen in
+   trans_coords */
+void scene_transform(int frame)
+{
+    clear_matrix();
+    apply_matrix(&screenview_matrix);
+    apply_matrix(&projection_matrix);
+    apply_matrix(&translation_matrix);
+    rotate_x(frame);
+    rotate_y(frame);
+    rotate_z(frame);
+    transform_coords(coords, trans_coords, 8);
+}
+
+/* The six faces of a cube with corners c, as trans_coords has them */
+void draw_cube(float (*c)[3])
+{
+    draw_face(c[0], c[1], c[2], c[3], 0, 0);
+    draw_face(c[1], c[5], c[3], c[7], 1, 1);
+    draw_face(c[4], c[5], c[0], c[1], 2, 2);
+    draw_face(c[5], c[4], c[7], c[6], 3, 0);
+    draw_face(c[4], c[0], c[6], c[2], 4, 1);
+    draw_face(c[2], c[3], c[6], c[7], 5, 2);
+}
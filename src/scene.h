@@ -0,0 +1,47 @@
+#ifndef SCENE_H_INCLUDED
+#define SCENE_H_INCLUDED
+
+#include "dc_types.h"
+#include "fractal.h"
+#include "vtex.h"
+
+/*
+  What is drawn: the spinning cube, the formula on each face and the
+  textures they bind, from the formula atlases or, with LOD, from
+  src/lod.c. main() and host/bench both compile this file, so the
+  benchmarked frame is the one the console draws.
+*/
+
+/* The framebuffer, in pixels */
+#define WIDTH  640
+#define HEIGHT 480
+
+extern float screenview_matrix[4][4];
+extern float projection_matrix[4][4];
+extern float translation_matrix[4][4];
+
+extern float coords[8][3];
+extern float trans_coords[8][3];
+
+extern int face_formula[6];
+extern uint16_t *tex[FRACTAL_FORMULAS];
+extern int formulas[FRACTAL_FORMULAS], formula_count;
+
+float fsin(float r);
+float fcos(float r);
+void rotate_x(int n);
+void rotate_y(int n);
+void rotate_z(int n);
+void scene_transform(int frame);
+
+#ifdef VTEX
+extern vt_camera camera;
+void camera_update();
+#endif
+
+void atlas_init();
+uint16_t *lod_vram(uint32_t bytes);
+void draw_face(float *p1, float *p2, float *p3, float *p4, int face, int pal);
+void draw_cube(float (*c)[3]);
+
+#endif /* SCENE_H_INCLUDED */
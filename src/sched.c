@@ -0,0 +1,125 @@
+#include "sched.h"
+#include "timer.h"
+
+
+
+/*
+ Scheduler
+ */
+
+sched_job sched_jobs[SCHED_MAX_JOBS];
+int sched_job_count;
+sched_stats sched_info;
+uint32_t (*sched_clock)() = timer_ticks;
+
+static uint32_t budget;
+static int owed = -1;       /* passed over for not fitting, runs next frame */
+static uint32_t owed_frame;
+
+/* Returns the job's index, or -1 if the table is full. The new job
+   starts level with the least served one so it can't take over */
+int sched_add(const char *name, int (*step)(void *arg), void *arg)
+{
+    sched_job *j;
+    uint32_t least = 0;
+
+    if(sched_job_count == SCHED_MAX_JOBS)
+        return -1;
+
+    for(int k = 0; k < sched_job_count; k++)
+        if(k == 0 || sched_jobs[k].ticks < least)
+            least = sched_jobs[k].ticks;
+
+    j = &sched_jobs[sched_job_count];
+    j->name = name;
+    j->step = step;
+    j->arg = arg;
+    j->state = SCHED_MORE;
+    j->ticks = least;
+    j->steps = j->longest = j->average = 0;
+
+    return sched_job_count++;
+}
+
+/* Start a frame that may spend up to budget ticks on jobs */
+void sched_frame(uint32_t frame_budget)
+{
+    if(sched_info.frames) {
+        if(sched_info.used > budget)
+            sched_info.overruns++;
+        if(sched_info.used > sched_info.worst)
+            sched_info.worst = sched_info.used;
+    }
+
+    sched_info.frames++;
+    sched_info.used = 0;
+    budget = frame_budget;
+
+    for(int k = 0; k < sched_job_count; k++)
+        if(sched_jobs[k].state == SCHED_IDLE)
+            sched_jobs[k].state = SCHED_MORE;
+}
+
+/* Run one step of the job that's had the least time among those that
+   fit in the budget left. Returns 0 when there is nothing that fits */
+int sched_run()
+{
+    sched_job *j = 0;
+    uint32_t t;
+    int state;
+
+    if(sched_info.used >= budget)
+        return 0;
+
+    for(int k = 0; k < sched_job_count; k++)
+        if(sched_jobs[k].state == SCHED_MORE && (!j || sched_jobs[k].ticks < j->ticks))
+            j = &sched_jobs[k];
+
+    /* If the least served job doesn't fit it runs over next frame instead,
+       and the rest of this one goes to jobs that fit */
+    if(j && sched_info.used && sched_info.used + j->average > budget
+         && (owed != j - sched_jobs || owed_frame == sched_info.frames))
+    {
+        owed = j - sched_jobs;
+        owed_frame = sched_info.frames;
+        j = 0;
+
+        for(int k = 0; k < sched_job_count; k++)
+        {
+            sched_job *c = &sched_jobs[k];
+
+            if(c->state == SCHED_MORE && sched_info.used + c->average <= budget && (!j || c->ticks < j->ticks))
+                j = c;
+        }
+    }
+
+    if(!j)
+        return 0;
+
+    t = sched_clock();
+    state = j->step(j->arg);
+    t = sched_clock() - t;
+
+    j->ticks += t;
+    j->steps++;
+    if(t > j->longest)
+        j->longest = t;
+    j->average = j->steps == 1 ? t : j->average - (j->average >> 2) + (t >> 2);
+    sched_info.used += t;
+
+    if(owed == j - sched_jobs)
+        owed = -1;
+
+    /* Finished jobs are removed, keeping the others in order */
+    if(state == SCHED_DONE) {
+        if(owed > j - sched_jobs)
+            owed--;
+        for(sched_job *k = j; k + 1 < sched_jobs + sched_job_count; k++)
+            k[0] = k[1];
+        sched_job_count--;
+    }
+    else
+        j->state = state;
+
+    return 1;
+}
@@ -0,0 +1,62 @@
+#ifndef SCHED_H_INCLUDED
+#define SCHED_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Cooperative background jobs
+
+  A job is a step function run between frames. Each call does a bounded
+  piece of work and returns at a safe point:
+
+    SCHED_MORE  more work is ready now
+    SCHED_IDLE  nothing more until the next frame
+    SCHED_DONE  finished, the job is removed
+
+  sched_run() starts the runnable job that has had the least time so
+  far, so jobs share the CPU evenly whatever their step lengths. A step
+  is only started if its average length fits in what's left of the
+  frame's budget, or if it's the first of the frame; a least served job
+  passed over that way is started next frame even if it doesn't fit, so
+  long steps don't starve. Frames whose jobs run past the budget are
+  counted. Time comes from sched_clock, which a
+  host build can replace for deterministic runs.
+*/
+
+#define SCHED_MORE 0
+#define SCHED_IDLE 1
+#define SCHED_DONE 2
+
+#define SCHED_MAX_JOBS 8
+
+typedef struct
+{
+    const char *name;
+    int (*step)(void *arg);
+    void *arg;
+
+    int state;          /* SCHED_* after the last step */
+    uint32_t ticks;     /* time in step(), plus the start it was given */
+    uint32_t steps;
+    uint32_t longest;   /* ticks of the longest step */
+    uint32_t average;   /* running average of the step length */
+} sched_job;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t used;      /* ticks spent on jobs this frame */
+    uint32_t overruns;  /* frames whose jobs ran past the budget */
+    uint32_t worst;     /* most ticks spent in a frame */
+} sched_stats;
+
+extern sched_job sched_jobs[SCHED_MAX_JOBS];
+extern int sched_job_count;
+extern sched_stats sched_info;
+extern uint32_t (*sched_clock)();
+
+int sched_add(const char *name, int (*step)(void *arg), void *arg);
+void sched_frame(uint32_t budget);
+int sched_run();
+
+#endif /* SCHED_H_INCLUDED */
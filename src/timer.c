@@ -0,0 +1,45 @@
+#include "timer.h"
+
+#ifdef __sh__
+#include "dc_registers.h"
+#else
+#include <time.h>
+#endif
+
+
+
+/*
+ Timer
+ */
+
+#ifdef __sh__
+
+void timer_init()
+{
+    hal_write(TSTR, hal_read(TSTR) & ~1);
+    hal_write(TCR0, 0);               /* Pphi/4, no interrupt */
+    hal_write(TCOR0, 0xFFFFFFFF);
+    hal_write(TCNT0, 0xFFFFFFFF);
+    hal_write(TSTR, hal_read(TSTR) | 1);
+}
+
+/* TCNT0 counts down */
+uint32_t timer_ticks()
+{
+    return ~hal_read(TCNT0);
+}
+
+#else
+
+void timer_init()
+{
+}
+
+uint32_t timer_ticks()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+#endif
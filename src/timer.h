@@ -0,0 +1,23 @@
+#ifndef TIMER_H_INCLUDED
+#define TIMER_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Free running tick counter
+
+  On the console TMU channel 0 counts the 50 MHz peripheral clock / 4;
+  host builds count nanoseconds. Differences of timer_ticks() are valid
+  across wraparound.
+*/
+
+#ifdef __sh__
+#define TIMER_HZ 12500000
+#else
+#define TIMER_HZ 1000000000
+#endif
+
+void timer_init();
+uint32_t timer_ticks();
+
+#endif /* TIMER_H_INCLUDED */
@@ -0,0 +1,135 @@
+#include "vram.h"
+#include "dc_locations.h"
+
+
+
+/*
+ VRAM
+ */
+
+#define BANK_SIZE (VRAM_BANK2_BASE - VRAM_BANK1_BASE)
+
+vram_region vram_regions[VRAM_MAX_REGIONS];
+int vram_region_count;
+
+static uint32_t top[2];         /* bank-local end of the arena */
+static uint32_t bottom[2];      /* bank-local start of the frame scratch */
+static uint32_t used, padding, peak;
+
+static const uint32_t bank_base[2] = { VRAM_BANK1_BASE, VRAM_BANK2_BASE };
+
+static uint32_t align_up(uint32_t x, uint32_t align)
+{
+    return (x + align - 1) & ~(align - 1);
+}
+
+static void track_peak()
+{
+    uint32_t scratch = 2*BANK_SIZE - bottom[0] - bottom[1];
+
+    if(used + padding + scratch > peak)
+        peak = used + padding + scratch;
+}
+
+void vram_init()
+{
+    for(int b = 0; b < 2; b++) {
+        top[b] = 0;
+        bottom[b] = BANK_SIZE;
+    }
+
+    used = padding = peak = 0;
+    vram_region_count = 0;
+}
+
+/* Allocate size bytes aligned to align (a power of two) in the given
+   address space, returns VRAM_FAIL when it doesn't fit */
+uint32_t vram_alloc(int bank, uint32_t size, uint32_t align, const char *name)
+{
+    uint32_t offset;
+
+    if(bank == VRAM_TEX64)
+    {
+        /* Same bank-local range in both banks, 8 byte granules */
+        uint32_t half = align_up(size, 8) / 2;
+        uint32_t start = align_up(top[0] > top[1] ? top[0] : top[1], align < 8 ? 4 : align / 2);
+
+        if(start + half > bottom[0] || start + half > bottom[1])
+            return VRAM_FAIL;
+
+        padding += 2*start - top[0] - top[1] + 2*half - size;
+        top[0] = top[1] = start + half;
+        offset = 2*start;
+    }
+    else
+    {
+        uint32_t start = align_up(top[bank], align);
+
+        if(start + size > bottom[bank])
+            return VRAM_FAIL;
+
+        padding += start - top[bank];
+        top[bank] = start + size;
+        offset = bank_base[bank] + start;
+    }
+
+    used += size;
+    track_peak();
+
+    if(vram_region_count < VRAM_MAX_REGIONS) {
+        vram_region *r = &vram_regions[vram_region_count++];
+        r->name = name;
+        r->offset = offset;
+        r->size = size;
+        r->bank = bank;
+    }
+
+    return offset;
+}
+
+/* Allocate from the top of a 32-bit bank until the next vram_frame_begin() */
+uint32_t vram_scratch(int bank, uint32_t size, uint32_t align)
+{
+    uint32_t start;
+
+    if(size > bottom[bank] - top[bank])
+        return VRAM_FAIL;
+
+    start = (bottom[bank] - size) & ~(align - 1);
+    if(start < top[bank])
+        return VRAM_FAIL;
+
+    bottom[bank] = start;
+    track_peak();
+
+    return bank_base[bank] + start;
+}
+
+void vram_frame_begin()
+{
+    bottom[0] = bottom[1] = BANK_SIZE;
+}
+
+/* free - largest is what fragmentation costs: the free bytes no single
+   allocation can have */
+void vram_report(vram_stats *stats)
+{
+    uint32_t free0 = bottom[0] - top[0], free1 = bottom[1] - top[1];
+
+    stats->used = used;
+    stats->padding = padding;
+    stats->scratch = 2*BANK_SIZE - bottom[0] - bottom[1];
+    stats->peak = peak;
+    stats->free = free0 + free1;
+    stats->largest = free0 > free1 ? free0 : free1;
+}
+
+void *vram32(uint32_t offset)
+{
+    return (void*)(VRAM_BASE + offset);
+}
+
+void *vram64(uint32_t offset)
+{
+    return (void*)(VRAM64_BASE + offset);
+}
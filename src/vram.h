@@ -0,0 +1,58 @@
+#ifndef VRAM_H_INCLUDED
+#define VRAM_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  VRAM arena
+
+  VRAM is two 4 MB banks. The 32-bit path (VRAM_BASE) sees bank 1 then
+  bank 2; the 64-bit path (VRAM64_BASE), which textures are read through,
+  interleaves them every 4 bytes. A 64-bit allocation therefore takes the
+  same bank-local range in both banks, half its size in each.
+
+  Allocations grow up from the bottom of each bank and are never freed.
+  Frame scratch grows down from the top and is dropped by
+  vram_frame_begin(). Offsets returned by VRAM_BANK1/2 allocations are
+  32-bit path offsets (VRAM_BASE + offset), VRAM_TEX64 ones are 64-bit
+  path offsets (VRAM64_BASE + offset).
+*/
+
+#define VRAM_BANK1  0
+#define VRAM_BANK2  1
+#define VRAM_TEX64  2
+
+#define VRAM_FAIL   0xFFFFFFFF
+#define VRAM_MAX_REGIONS 16
+
+typedef struct
+{
+    const char *name;
+    uint32_t offset;
+    uint32_t size;
+    int bank;
+} vram_region;
+
+typedef struct
+{
+    uint32_t used;      /* bytes handed out, both banks */
+    uint32_t padding;   /* bytes lost to alignment and bank imbalance */
+    uint32_t scratch;   /* frame scratch in use */
+    uint32_t peak;      /* most used + padding + scratch seen */
+    uint32_t free;      /* between the arenas and the scratch, both banks */
+    uint32_t largest;   /* biggest free range in one bank */
+} vram_stats;
+
+extern vram_region vram_regions[VRAM_MAX_REGIONS];
+extern int vram_region_count;
+
+void vram_init();
+uint32_t vram_alloc(int bank, uint32_t size, uint32_t align, const char *name);
+uint32_t vram_scratch(int bank, uint32_t size, uint32_t align);
+void vram_frame_begin();
+void vram_report(vram_stats *stats);
+
+void *vram32(uint32_t offset);
+void *vram64(uint32_t offset);
+
+#endif /* VRAM_H_INCLUDED */
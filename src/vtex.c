@@ -0,0 +1,276 @@
+#include "vtex.h"
+#include "fractal.h"
+
+
+
+/*
+ Virtual texture
+ */
+
+#define NO_TILE   0xFFFFFFFF
+#define HASH_SIZE 256
+#define NIL       (-1)
+
+typedef struct
+{
+    uint32_t key;
+    uint32_t stamp;     /* frame of last use, for LRU */
+    int16_t next;       /* hash chain */
+} vt_slot;
+
+vt_stats vtex_stats;
+
+static uint16_t *pool;
+static vt_slot slots[VT_POOL];
+static int16_t buckets[HASH_SIZE];
+static uint32_t frame_clock;
+static int budget;
+
+/* What each face position currently shows, NO_TILE if a fallback */
+static uint32_t assembled[VT_FACES][VT_TILES * VT_TILES];
+
+/* Face positions, nearest to the centre first, so a tight budget
+   spends itself where the viewer looks */
+static uint8_t order[VT_TILES * VT_TILES];
+
+static uint32_t tile_key(int formula, int level, int x, int y)
+{
+    return (uint32_t)formula << 29 | level << 26 | (x & 0x1fff) << 13 | (y & 0x1fff);
+}
+
+static int hash(uint32_t key)
+{
+    return (key ^ key >> 8 ^ key >> 16 ^ key >> 24) & (HASH_SIZE - 1);
+}
+
+static int lookup(uint32_t key)
+{
+    for(int s = buckets[hash(key)]; s != NIL; s = slots[s].next)
+        if(slots[s].key == key)
+            return s;
+
+    return NIL;
+}
+
+static void unlink_slot(int s)
+{
+    int16_t *p = &buckets[hash(slots[s].key)];
+
+    while(*p != s)
+        p = &slots[*p].next;
+
+    *p = slots[s].next;
+}
+
+/* Least recently used slot that wasn't used this frame */
+static int victim()
+{
+    int best = NIL;
+
+    for(int s = 0; s < VT_POOL; s++)
+    {
+        if(slots[s].key == NO_TILE)
+            return s;
+
+        if(slots[s].stamp != frame_clock && (best == NIL || slots[s].stamp < slots[best].stamp))
+            best = s;
+    }
+
+    return best;
+}
+
+static uint16_t *slot_data(int s)
+{
+    return pool + s * (VT_TILE_BYTES / 2);
+}
+
+static void copy_tile(uint16_t *dst, const uint16_t *src)
+{
+    uint32_t *d = (uint32_t*)dst;
+    const uint32_t *s = (const uint32_t*)src;
+
+    for(int n = 0; n < VT_TILE_BYTES / 4; n++)
+        d[n] = s[n];
+}
+
+/* Squared distance of a face position from the face centre, in half tiles */
+static int centre_dist(int p)
+{
+    int a = 2*(p % VT_TILES) - VT_TILES + 1;
+    int b = 2*(p / VT_TILES) - VT_TILES + 1;
+
+    return a*a + b*b;
+}
+
+void vtex_init(uint16_t *tile_pool)
+{
+    pool = tile_pool;
+
+    for(int s = 0; s < VT_POOL; s++)
+        slots[s].key = NO_TILE;
+
+    for(int h = 0; h < HASH_SIZE; h++)
+        buckets[h] = NIL;
+
+    for(int f = 0; f < VT_FACES; f++)
+        for(int p = 0; p < VT_TILES * VT_TILES; p++)
+            assembled[f][p] = NO_TILE;
+
+    /* Insertion sort by distance from the face centre */
+    for(int p = 0; p < VT_TILES * VT_TILES; p++)
+    {
+        int k = p;
+
+        for(; k > 0 && centre_dist(order[k-1]) > centre_dist(p); k--)
+            order[k] = order[k-1];
+
+        order[k] = p;
+    }
+}
+
+/* Move the camera by (dx, dy) texels of its current level */
+void vtex_pan(vt_camera *cam, double dx, double dy)
+{
+    cam->x += dx / (1 << cam->level);
+    cam->y += dy / (1 << cam->level);
+}
+
+void vtex_zoom(vt_camera *cam, int levels)
+{
+    cam->level += levels;
+
+    if(cam->level < 0)
+        cam->level = 0;
+    if(cam->level > VT_LEVELS - 1)
+        cam->level = VT_LEVELS - 1;
+}
+
+/* Start a frame that may compute up to max_tiles missing tiles */
+void vtex_begin_frame(int max_tiles)
+{
+    frame_clock++;
+    budget = max_tiles;
+}
+
+/* Show a coarser resident tile scaled up, returns 0 if there is none */
+static int fallback(uint16_t *dst, int i0, int j0, int formula, int level, int x, int y)
+{
+    static uint32_t parent[VT_TILE_BYTES / 4];
+    const uint8_t *texels = (const uint8_t*)parent;
+
+    for(int d = 1; d <= level; d++)
+    {
+        int s = lookup(tile_key(formula, level - d, x >> d, y >> d));
+        int ox, oy;
+
+        if(s == NIL)
+            continue;
+
+        slots[s].stamp = frame_clock;
+        copy_tile((uint16_t*)parent, slot_data(s));
+
+        ox = (x & ((1 << d) - 1)) * VT_TILE;
+        oy = (y & ((1 << d) - 1)) * VT_TILE;
+
+        for(int li = 0; li < VT_TILE; li++)
+            for(int lj = 0; lj < VT_TILE; lj++)
+            {
+                int pi = (ox + li) >> d, pj = (oy + lj) >> d;
+                fractal_block[li][lj] = texels[twiddletab[pi] << 1 | twiddletab[pj]];
+            }
+
+        fractal_upload_block(dst, i0, j0);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Tile containing a level texel coordinate, rounding towards -inf */
+static int texel_to_tile(double t)
+{
+    int i = (int)t;
+
+    if(i > t)
+        i--;
+
+    return i >= 0 ? i / VT_TILE : -((VT_TILE - 1 - i) / VT_TILE);
+}
+
+/* Corner of the window in level texels, where the tiles start */
+static double window_corner(double c, int level)
+{
+    return c * (1 << level) - VT_WINDOW / 2;
+}
+
+/* Where the window starts in the face texture, as a fraction of it: the
+   part of a tile the camera is past its corner */
+void vtex_window(const vt_camera *cam, float *u0, float *v0)
+{
+    double x = window_corner(cam->x, cam->level);
+    double y = window_corner(cam->y, cam->level);
+
+    *u0 = (x - texel_to_tile(x) * VT_TILE) / 256;
+    *v0 = (y - texel_to_tile(y) * VT_TILE) / 256;
+}
+
+/* Bring a 256x256 face texture up to date with the camera */
+void vtex_assemble(uint16_t *dst, int face, int formula, const vt_camera *cam)
+{
+    int level = cam->level;
+    int tx0 = texel_to_tile(window_corner(cam->x, level));
+    int ty0 = texel_to_tile(window_corner(cam->y, level));
+
+    for(int n = 0; n < VT_TILES * VT_TILES; n++)
+    {
+        int p = order[n];
+        int a = p % VT_TILES, b = p / VT_TILES;
+        int x = tx0 + a, y = ty0 + b;
+        uint32_t key = tile_key(formula, level, x, y);
+        int s = lookup(key);
+
+        if(s != NIL)
+        {
+            vtex_stats.hits++;
+            slots[s].stamp = frame_clock;
+
+            if(assembled[face][p] != key) {
+                copy_tile(dst + (twiddletab[a * VT_TILE] | twiddletab[b * VT_TILE] >> 1), slot_data(s));
+                assembled[face][p] = key;
+            }
+            continue;
+        }
+
+        vtex_stats.misses++;
+
+        if(budget <= 0 && fallback(dst, a * VT_TILE, b * VT_TILE, formula, level, x, y))
+        {
+            vtex_stats.fallbacks++;
+            assembled[face][p] = NO_TILE;
+            continue;
+        }
+
+        /* Computed even over budget when nothing coarser is resident */
+        s = victim();
+        if(s == NIL)
+            continue;
+
+        if(slots[s].key != NO_TILE) {
+            unlink_slot(s);
+            vtex_stats.evictions++;
+        }
+
+        fractal_compute_block(x * VT_TILE, y * VT_TILE, level, formula);
+        fractal_upload_block(slot_data(s), 0, 0);
+        fractal_upload_block(dst, a * VT_TILE, b * VT_TILE);
+
+        slots[s].key = key;
+        slots[s].stamp = frame_clock;
+        slots[s].next = buckets[hash(key)];
+        buckets[hash(key)] = s;
+
+        assembled[face][p] = key;
+        vtex_stats.computed++;
+        budget--;
+    }
+}
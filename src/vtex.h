@@ -0,0 +1,55 @@
+#ifndef VTEX_H_INCLUDED
+#define VTEX_H_INCLUDED
+
+#include "dc_types.h"
+
+/*
+  Virtual texture over the fractal plane
+
+  Level L magnifies the level 0 view (the 256x256 startup textures) 2^L
+  times. Tiles of VT_TILE texels keyed by (formula, level, x, y) are computed
+  on demand into a fixed pool and evicted least recently used first. A
+  face texture is assembled from the 8x8 tiles around the camera; tiles
+  that aren't resident yet are filled in from the nearest coarser level
+  that is. Tiles change a whole tile at a time, so a face shows only the
+  VT_WINDOW texels centred on the camera, and vtex_window() gives where
+  that window starts inside the texture as the camera moves.
+*/
+
+#define VT_TILE       32
+#define VT_TILES      (256 / VT_TILE)
+#define VT_TILE_BYTES (VT_TILE * VT_TILE)
+#define VT_POOL       192
+#define VT_LEVELS     8
+#define VT_FACES      2
+
+#define VT_POOL_BYTES (VT_POOL * VT_TILE_BYTES)
+
+/* Texels of a face texture on screen, each way */
+#define VT_WINDOW     (256 - VT_TILE)
+
+typedef struct
+{
+    double x, y;    /* view centre in level 0 texels */
+    int level;
+} vt_camera;
+
+typedef struct
+{
+    uint32_t hits;          /* tile lookups served from the pool */
+    uint32_t misses;        /* tile lookups that weren't resident */
+    uint32_t computed;      /* misses computed this frame */
+    uint32_t fallbacks;     /* misses shown from a coarser level */
+    uint32_t evictions;
+} vt_stats;
+
+extern vt_stats vtex_stats;
+
+void vtex_init(uint16_t *pool);
+void vtex_pan(vt_camera *cam, double dx, double dy);
+void vtex_zoom(vt_camera *cam, int levels);
+void vtex_begin_frame(int budget);
+void vtex_assemble(uint16_t *dst, int face, int formula, const vt_camera *cam);
+void vtex_window(const vt_camera *cam, float *u0, float *v0);
+
+#endif /* VTEX_H_INCLUDED */
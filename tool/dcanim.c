@@ -0,0 +1,308 @@
+/*
+  dcanim - encode a fractal zoom into the stream format in src/anim.h
+
+    dcanim [-n frames] [-k interval] [-z frames_per_octave] out.fan
+    dcanim -t file...
+
+  The first form renders a zoom into the Mandelbrot texture's centre with
+  src/fractal.c, magnifying 2x every frames_per_octave frames (default
+  30), encodes it with a keyframe at least every interval frames
+  (default 30), then decodes it with src/anim.c, checks every
+  frame and a seek, and reports the compression ratio and decode MB/s.
+  Rendered frames go through the texture cache in tool/texcache.h, and
+  each octave's frame reuses the last one's texels (tool/zoom.h).
+  -t only decodes existing streams and reports the same.
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "anim.h"
+#include "fractal.h"
+#include "texcache.h"
+#include "zoom.h"
+
+#define MIN_TIME 0.25
+
+static uint8_t work[ANIM_WORK_BYTES] __attribute__((aligned(32)));
+static uint16_t map[ANIM_FRAME_BYTES];
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Frame f of the zoom, twiddled like fractal_store_block() leaves it.
+   Frames are rendered in order; every per_octave'th is a level of a
+   zoom_seq, which reuses a quarter of the last one's texels */
+static void render(uint8_t *dst, int f, int per_octave)
+{
+    static zoom_seq z;
+    double scale = pow(2.0, (double)f / per_octave);
+    int octave = f % per_octave == 0;
+    texcache_key k;
+
+    /* One sample per texel, so the key is level 0's without refinement */
+    texcache_key_for(&k, 0, 0);
+    k.refine = 0;
+    k.scale /= scale;
+    if(texcache_load(&k, dst, ANIM_FRAME_BYTES)) {
+        if(octave)
+            zoom_load(&z, 0, f / per_octave, 128, 128, dst);
+        return;
+    }
+
+    if(octave) {
+        if(f)
+            zoom_step(&z, 128, 128);
+        else
+            zoom_start(&z, 0, 128, 128);
+
+        zoom_store(&z, dst);
+        texcache_store(&k, dst, ANIM_FRAME_BYTES);
+        return;
+    }
+
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            dst[twiddletab[i] << 1 | twiddletab[j]] =
+                compute_sample(128 + (i - 128) / scale, 128 + (j - 128) / scale, 0);
+
+    texcache_store(&k, dst, ANIM_FRAME_BYTES);
+}
+
+static int emit(uint8_t *dst, const uint8_t *src, int n)
+{
+    *dst = n - 1;
+    memcpy(dst + 1, src, n);
+    return n + 1;
+}
+
+/* Run-length code n bytes, returns the payload size */
+static int rle(uint8_t *dst, const uint8_t *src, int n)
+{
+    int out = 0, lit = 0, k = 0;
+
+    while(k < n)
+    {
+        int run = 1;
+
+        while(k + run < n && run < 130 && src[k + run] == src[k])
+            run++;
+
+        if(run < 3) {
+            k += run;
+            lit += run;
+            while(lit >= 128) {
+                out += emit(dst + out, src + k - lit, 128);
+                lit -= 128;
+            }
+            continue;
+        }
+
+        if(lit)
+            out += emit(dst + out, src + k - lit, lit);
+        lit = 0;
+
+        dst[out++] = 0x80 | (run - 3);
+        dst[out++] = src[k];
+        k += run;
+    }
+
+    if(lit)
+        out += emit(dst + out, src + n - lit, lit);
+
+    return out;
+}
+
+static uint8_t *load(const char *path, long *n)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+
+    if(!f) {
+        perror(path);
+        exit(1);
+    }
+
+    fseek(f, 0, SEEK_END);
+    *n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    buf = malloc(*n + 4);
+    if(fread(buf, 1, *n, f) != (size_t)*n) {
+        perror(path);
+        exit(1);
+    }
+
+    fclose(f);
+    return buf;
+}
+
+/* Decode the whole stream repeatedly, returns MB/s of frames decoded */
+static double decode_speed(const uint8_t *stream)
+{
+    anim a;
+    double start = now(), t;
+    long bytes = 0;
+
+    anim_open(&a, stream, work);
+    do {
+        for(uint32_t f = 0; f < a.frames; f++) {
+            while(!anim_step(&a, ANIM_FRAME_BYTES))
+                ;
+            bytes += ANIM_FRAME_BYTES;
+        }
+    } while((t = now() - start) < MIN_TIME);
+
+    return bytes / t / 1e6;
+}
+
+static void report(const char *name, const uint8_t *stream, long size)
+{
+    uint32_t frames = ((const uint32_t*)stream)[1], keys = 0;
+
+    for(uint32_t f = 0; f < frames; f++)
+        keys += (((const uint32_t*)stream)[ANIM_HEADER / 4 + f] & ANIM_KEY) != 0;
+
+    printf("%s: %u frames, %u keyframes, %ld bytes, ratio %.2f, decode %.1f MB/s\n",
+           name, frames, keys, size, (double)frames * ANIM_FRAME_BYTES / size, decode_speed(stream));
+}
+
+static int test(int argc, char **argv)
+{
+    for(int i = 0; i < argc; i++)
+    {
+        long n;
+        uint8_t *stream = load(argv[i], &n);
+        anim a;
+
+        if(!anim_open(&a, stream, work)) {
+            fprintf(stderr, "%s: not an animation stream\n", argv[i]);
+            return 1;
+        }
+
+        report(argv[i], stream, n);
+        free(stream);
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = 120, interval = 30, per_octave = 30;
+    const char *path = 0;
+    uint8_t *video, *stream, *delta;
+    uint32_t *index;
+    long size;
+    anim a;
+    FILE *f;
+
+    if(argc > 1 && !strcmp(argv[1], "-t"))
+        return test(argc - 2, argv + 2);
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-k") && i + 1 < argc)
+            interval = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-z") && i + 1 < argc)
+            per_octave = atoi(argv[++i]);
+        else if(argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+            path = 0, i = argc;
+    }
+
+    if(!path || frames < 1 || interval < 1 || per_octave < 1) {
+        fprintf(stderr, "usage: %s [-n frames] [-k interval] [-z frames_per_octave] out.fan\n"
+                        "       %s -t file...\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    fractal_init();
+
+    video = malloc((long)frames * ANIM_FRAME_BYTES);
+    for(int k = 0; k < frames; k++)
+        render(video + (long)k * ANIM_FRAME_BYTES, k, per_octave);
+
+    /* Worst case: every frame verbatim in 128 byte literals */
+    stream = malloc(ANIM_HEADER + 4L * frames + (long)frames * (4 + ANIM_FRAME_BYTES + ANIM_FRAME_BYTES / 128 + 4));
+    delta = malloc(ANIM_FRAME_BYTES);
+    index = (uint32_t*)(stream + ANIM_HEADER);
+
+    ((uint32_t*)stream)[0] = ANIM_MAGIC;
+    ((uint32_t*)stream)[1] = frames;
+    ((uint32_t*)stream)[2] = interval;
+    ((uint32_t*)stream)[3] = (uint32_t)(pow(2.0, 1.0 / per_octave) * 65536 + 0.5);
+    anim_zoom_map(map, ((uint32_t*)stream)[3]);
+    size = ANIM_HEADER + 4L * frames;
+
+    for(int k = 0, since_key = 0; k < frames; k++, since_key++)
+    {
+        static uint8_t coded[ANIM_FRAME_BYTES + ANIM_FRAME_BYTES / 128 + 4];
+        const uint8_t *cur = video + (long)k * ANIM_FRAME_BYTES;
+        uint8_t *payload = stream + size + 4;
+        int n = rle(payload, cur, ANIM_FRAME_BYTES), key = 1;
+
+        /* Delta unless a keyframe is due or the texels code smaller anyway */
+        if(k > 0 && since_key < interval)
+        {
+            int m;
+
+            for(int t = 0; t < ANIM_FRAME_BYTES; t++)
+                delta[t] = cur[t] - cur[map[t] - ANIM_FRAME_BYTES];
+
+            m = rle(coded, delta, ANIM_FRAME_BYTES);
+            if(m < n) {
+                memcpy(payload, coded, m);
+                n = m;
+                key = 0;
+            }
+        }
+
+        if(key)
+            since_key = 0;
+
+        index[k] = size | (key ? ANIM_KEY : 0);
+        *(uint32_t*)(stream + size) = n;
+        size += 4 + n;
+        while(size & 3)
+            stream[size++] = 0;
+    }
+
+    if(!(f = fopen(path, "wb")) || fwrite(stream, 1, size, f) != (size_t)size) {
+        perror(path);
+        return 1;
+    }
+    fclose(f);
+
+    /* Every frame in order, then a seek into the middle of a run of deltas */
+    anim_open(&a, stream, work);
+    for(int k = 0; k < frames; k++)
+    {
+        while(!anim_step(&a, 4096))
+            ;
+        if(memcmp(a.out, video + (long)k * ANIM_FRAME_BYTES, ANIM_FRAME_BYTES)) {
+            fprintf(stderr, "frame %d decodes wrong\n", k);
+            return 1;
+        }
+    }
+
+    anim_seek(&a, frames * 2 / 3);
+    while(!anim_step(&a, 4096))
+        ;
+    if(memcmp(a.out, video + (long)(frames * 2 / 3) * ANIM_FRAME_BYTES, ANIM_FRAME_BYTES)) {
+        fprintf(stderr, "seek to frame %d decodes wrong\n", frames * 2 / 3);
+        return 1;
+    }
+
+    report(path, stream, size);
+    return 0;
+}
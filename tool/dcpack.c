@@ -0,0 +1,119 @@
+/*
+  dcpack - compress a.bin for the packed build
+
+    dcpack in.bin out.lz      pack in.bin into the stream format in lzss.h
+    dcpack -t file...         round trip each file through the C unpacker,
+                              report ratio and MB/s, exit 1 on mismatch
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lzss.h"
+
+static uint8_t *load(const char *path, int *n)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *buf;
+
+    if(!f) {
+        perror(path);
+        exit(1);
+    }
+
+    fseek(f, 0, SEEK_END);
+    *n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    buf = malloc(*n ? *n : 1);
+    if(fread(buf, 1, *n, f) != (size_t)*n) {
+        perror(path);
+        exit(1);
+    }
+
+    fclose(f);
+    return buf;
+}
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int roundtrip(const char *path)
+{
+    int n, packed, reps = 0;
+    uint8_t *src = load(path, &n);
+    uint8_t *lz  = malloc(LZSS_BOUND(n));
+    uint8_t *out = malloc(n ? n : 1);
+    double t0, t_pack, t_unpack;
+
+    t0 = now();
+    packed = lzss_pack(src, n, lz);
+    t_pack = now() - t0;
+
+    /* Unpacking is fast, repeat it for at least a tenth of a second */
+    t0 = now();
+    do {
+        lzss_unpack(lz, out);
+        reps++;
+    } while(now() - t0 < 0.1);
+    t_unpack = (now() - t0) / reps;
+
+    if(memcmp(src, out, n)) {
+        fprintf(stderr, "%s: round trip mismatch\n", path);
+        return 1;
+    }
+
+    printf("%s: %d -> %d bytes (%.1f%%), pack %.1f MB/s, unpack %.1f MB/s\n",
+           path, n, packed, n ? 100.0 * packed / n : 0.0,
+           n / t_pack / 1e6, n / t_unpack / 1e6);
+
+    free(src);
+    free(lz);
+    free(out);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc >= 3 && !strcmp(argv[1], "-t"))
+    {
+        int fail = 0;
+
+        for(int i = 2; i < argc; i++)
+            fail |= roundtrip(argv[i]);
+
+        return fail;
+    }
+
+    if(argc == 3)
+    {
+        int n, packed;
+        uint8_t *src = load(argv[1], &n);
+        uint8_t *lz  = malloc(LZSS_BOUND(n) + 3);
+        FILE *f;
+
+        packed = lzss_pack(src, n, lz);
+
+        /* Pad to a long so the relocation copy in crt0.s can move longs */
+        while(packed & 3)
+            lz[packed++] = 0;
+
+        f = fopen(argv[2], "wb");
+        if(!f || fwrite(lz, 1, packed, f) != (size_t)packed) {
+            perror(argv[2]);
+            return 1;
+        }
+        fclose(f);
+
+        printf("%s: %d -> %d bytes\n", argv[1], n, packed);
+        return 0;
+    }
+
+    fprintf(stderr, "usage: %s in.bin out.lz\n"
+                    "       %s -t file...\n", argv[0], argv[0]);
+    return 1;
+}
@@ -0,0 +1,135 @@
+#include "lzss.h"
+
+#define HASH_BITS 12
+#define HASH_SIZE (1 << HASH_BITS)
+#define NIL       (-1)
+
+/* Chains longer than this rarely find anything better and cost a lot of
+   time on long runs of zeros */
+#define MAX_CHAIN 256
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static int hash3(const uint8_t *p)
+{
+    return ((p[0] << 8 ^ p[1] << 4 ^ p[2]) * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/* Greedy LZSS with hash chains. Returns the packed size including the
+   header. dst must hold LZSS_BOUND(n) bytes. */
+int lzss_pack(const uint8_t *src, int n, uint8_t *dst)
+{
+    static int head[HASH_SIZE];
+    static int prev[LZSS_WINDOW + 1];
+
+    uint8_t *out = dst + LZSS_HEADER;
+    uint8_t *flags = 0;
+    int bit = 8;
+    int i = 0;
+
+    for(int h = 0; h < HASH_SIZE; h++)
+        head[h] = NIL;
+
+    while(i < n)
+    {
+        int best_len = 0, best_dist = 0;
+
+        if(bit == 8) {
+            flags = out++;
+            *flags = 0;
+            bit = 0;
+        }
+
+        if(i + LZSS_MIN <= n)
+        {
+            int limit = n - i < LZSS_MAX ? n - i : LZSS_MAX;
+            int chain = MAX_CHAIN;
+
+            for(int m = head[hash3(src + i)]; m != NIL && i - m <= LZSS_WINDOW && chain--; m = prev[m % (LZSS_WINDOW + 1)])
+            {
+                int len = 0;
+
+                while(len < limit && src[m + len] == src[i + len])
+                    len++;
+
+                if(len > best_len) {
+                    best_len = len;
+                    best_dist = i - m;
+                    if(len == limit)
+                        break;
+                }
+            }
+        }
+
+        if(best_len < LZSS_MIN)
+        {
+            *flags |= 1 << bit;
+            *out++ = src[i];
+            best_len = 1;
+        }
+        else
+        {
+            *out++ = best_dist;
+            *out++ = (best_dist >> 4 & 0xf0) | (best_len - LZSS_MIN);
+        }
+        bit++;
+
+        /* Insert every position we step over into the chains */
+        for(int k = 0; k < best_len; k++, i++)
+            if(i + LZSS_MIN <= n) {
+                int h = hash3(src + i);
+                prev[i % (LZSS_WINDOW + 1)] = head[h];
+                head[h] = i;
+            }
+    }
+
+    put32(dst, n);
+    put32(dst + 4, out - dst - LZSS_HEADER);
+
+    return out - dst;
+}
+
+/* C version of the unpacker in crt0.s, same control flow. Returns the
+   unpacked size. */
+int lzss_unpack(const uint8_t *src, uint8_t *dst)
+{
+    int n = get32(src);
+    uint8_t *end = dst + n;
+    unsigned flags = 0;
+
+    src += LZSS_HEADER;
+
+    while(dst < end)
+    {
+        if(!(flags & 0x100))
+            flags = *src++ | 0xff00;
+
+        if(flags & 1)
+            *dst++ = *src++;
+        else
+        {
+            int dist = src[0] | (src[1] & 0xf0) << 4;
+            int len  = (src[1] & 0x0f) + LZSS_MIN;
+            const uint8_t *m = dst - dist;
+
+            src += 2;
+            while(len--)
+                *dst++ = *m++;
+        }
+
+        flags >>= 1;
+    }
+
+    return n;
+}
@@ -0,0 +1,32 @@
+#ifndef LZSS_H_INCLUDED
+#define LZSS_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+  Packed stream layout (little endian):
+
+    u32 unpacked size
+    u32 packed size (bytes following this header)
+    groups of: one flag byte, LSB first, followed by 8 items
+      flag 1: literal byte
+      flag 0: match, 2 bytes b0 b1
+              distance = b0 | (b1 & 0xf0) << 4   (1..4095)
+              length   = (b1 & 0x0f) + 3         (3..18)
+
+  The stream is decoded until the unpacked size is reached. This is the
+  format the unpacker in src/crt0.s reads.
+*/
+
+#define LZSS_HEADER   8
+#define LZSS_WINDOW   4095
+#define LZSS_MIN      3
+#define LZSS_MAX      18
+
+/* Worst case packed size for n input bytes */
+#define LZSS_BOUND(n) (LZSS_HEADER + (n) + ((n) + 7) / 8)
+
+int lzss_pack(const uint8_t *src, int n, uint8_t *dst);
+int lzss_unpack(const uint8_t *src, uint8_t *dst);
+
+#endif /* LZSS_H_INCLUDED */
@@ -0,0 +1,136 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "texcache.h"
+#include "lzss.h"
+#include "fractal.h"
+
+const char *texcache_dir = ".texcache";
+
+/* FNV-1a over the key */
+static uint64_t hash(const texcache_key *k)
+{
+    const uint8_t *p = (const uint8_t*)k;
+    uint64_t h = 14695981039346656037ull;
+
+    for(unsigned i = 0; i < sizeof(*k); i++)
+        h = (h ^ p[i]) * 1099511628211ull;
+
+    return h;
+}
+
+static void path_of(char *path, int n, const texcache_key *k)
+{
+    snprintf(path, n, "%s/%016llx.ftex", texcache_dir, (unsigned long long)hash(k));
+}
+
+/* The key of the level's texture as fractal_build() and
+   fractal_compute_block() make it now */
+void texcache_key_for(texcache_key *k, int formula, int level)
+{
+    memset(k, 0, sizeof(*k));
+    k->formula = formula;
+    k->size = 256 << level;
+    k->max_iter = FRACTAL_MAX_ITER;
+    k->version = FRACTAL_VERSION;
+    k->refine = fractal_refine;
+    fractal_view(formula, &k->re, &k->im, &k->scale);
+    k->scale /= 1 << level;
+}
+
+/* Returns 1 and fills dst if the cache has bytes of texels for k */
+int texcache_load(const texcache_key *k, void *dst, int bytes)
+{
+    char path[512];
+    struct stat st;
+    const uint8_t *map;
+    int fd, hit = 0;
+
+    if(!texcache_dir)
+        return 0;
+
+    path_of(path, sizeof(path), k);
+    if((fd = open(path, O_RDONLY)) < 0)
+        return 0;
+
+    if(fstat(fd, &st) == 0 && st.st_size >= (off_t)(4 + sizeof(*k) + LZSS_HEADER)
+        && (map = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED)
+    {
+        const uint8_t *stream = map + 4 + sizeof(*k);
+        uint32_t size, packed;
+
+        memcpy(&size, stream, 4);
+        memcpy(&packed, stream + 4, 4);
+
+        if(*(const uint32_t*)map == TEXCACHE_MAGIC && !memcmp(map + 4, k, sizeof(*k))
+            && size == (uint32_t)bytes && 4 + sizeof(*k) + LZSS_HEADER + packed <= (size_t)st.st_size)
+            hit = lzss_unpack(stream, dst) == bytes;
+
+        munmap((void*)map, st.st_size);
+    }
+
+    close(fd);
+    return hit;
+}
+
+void texcache_store(const texcache_key *k, const void *src, int bytes)
+{
+    char path[512], tmp[520];
+    uint8_t *buf;
+    uint32_t magic = TEXCACHE_MAGIC;
+    FILE *f;
+    int n;
+
+    if(!texcache_dir)
+        return;
+
+    mkdir(texcache_dir, 0777);
+    path_of(path, sizeof(path), k);
+    snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+
+    buf = malloc(LZSS_BOUND(bytes));
+    n = lzss_pack(src, bytes, buf);
+
+    if((f = fopen(tmp, "wb")))
+    {
+        int ok = fwrite(&magic, 4, 1, f) == 1
+              && fwrite(k, sizeof(*k), 1, f) == 1
+              && fwrite(buf, 1, n, f) == (size_t)n;
+
+        if(fclose(f) == 0 && ok)
+            rename(tmp, path);
+        else
+            remove(tmp);
+    }
+
+    free(buf);
+}
+
+/* Build a level's (256 << level)^2 twiddled PAL8 texture through the
+   cache. Returns 1 on a hit */
+int texcache_build(uint16_t *dst, int formula, int level)
+{
+    int size = 256 << level;
+    texcache_key k;
+
+    texcache_key_for(&k, formula, level);
+    if(texcache_load(&k, dst, size * size))
+        return 1;
+
+    if(level == 0)
+        fractal_build(dst, formula);
+    else
+        for(int i0 = 0; i0 < size; i0 += FRACTAL_BLOCK)
+            for(int j0 = 0; j0 < size; j0 += FRACTAL_BLOCK) {
+                fractal_compute_block(i0, j0, level, formula);
+                fractal_store_block(dst, i0, j0);
+            }
+
+    texcache_store(&k, dst, size * size);
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef TEXCACHE_H_INCLUDED
+#define TEXCACHE_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+  On-disk cache of iteration maps, for host tools
+
+  A cached texture is keyed by everything its texels depend on: formula,
+  view centre and texel width, size, iteration limit, kernel version
+  (FRACTAL_VERSION) and refinement samples. The file name is a hash of
+  the key; the file holds
+
+    u32 TEXCACHE_MAGIC
+    texcache_key, checked on load so a hash collision is a miss
+    the texels, twiddled as they go to VRAM, as an lzss.h stream
+
+  Files are mapped and unpacked straight from the mapping. They're
+  written to a temporary name and renamed, so a crashed or concurrent
+  writer never leaves a torn entry.
+*/
+
+#define TEXCACHE_MAGIC 0x58455446 /* "FTEX" */
+
+typedef struct
+{
+    uint32_t formula;
+    uint32_t size;          /* texels per side */
+    uint32_t max_iter;
+    uint32_t version;
+    uint32_t refine;
+    uint32_t pad;
+    double re, im;          /* centre texel */
+    double scale;           /* texel width */
+} texcache_key;
+
+/* Directory of the cache, created on first store; 0 turns it off */
+extern const char *texcache_dir;
+
+void texcache_key_for(texcache_key *k, int formula, int level);
+int texcache_load(const texcache_key *k, void *dst, int bytes);
+void texcache_store(const texcache_key *k, const void *src, int bytes);
+int texcache_build(uint16_t *dst, int formula, int level);
+
+#endif /* TEXCACHE_H_INCLUDED */
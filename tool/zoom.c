@@ -0,0 +1,109 @@
+#include <math.h>
+#include <string.h>
+
+#include "zoom.h"
+#include "fractal.h"
+
+#define ONE ((int64_t)1 << ZOOM_BITS)
+
+int zoom_reuse = 1;
+
+/* Texel width of a level, in fixed point */
+static int64_t step_of(int level)
+{
+    return ONE >> level;
+}
+
+/* The texel of the level nearest x (level 0 texels), in fixed point */
+static int64_t snap(double x, int level)
+{
+    return (int64_t)llround(ldexp(x, level)) * step_of(level);
+}
+
+static uint8_t sample(const zoom_seq *z, int i, int j)
+{
+    int64_t s = step_of(z->level);
+
+    return compute_sample((double)(z->x + (i - 128) * s) * (1.0 / ONE),
+                          (double)(z->y + (j - 128) * s) * (1.0 / ONE), z->formula);
+}
+
+void zoom_start(zoom_seq *z, int formula, double x, double y)
+{
+    z->formula = formula;
+    z->level = 0;
+    z->x = snap(x, 0);
+    z->y = snap(y, 0);
+    z->computed = z->reused = 0;
+
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            z->counts[i][j] = sample(z, i, j);
+
+    z->computed += 256*256;
+}
+
+/* Zoom 2x towards (x, y) in level 0 texels. The centre moves by whole
+   old texels, (di, dj), so new texel (i, j) with i and j even is old
+   texel (128 + di + (i - 128) / 2, 128 + dj + (j - 128) / 2) */
+void zoom_step(zoom_seq *z, double x, double y)
+{
+    static uint8_t old[256][256];
+    int64_t s = step_of(z->level), nx, ny;
+    int di, dj;
+
+    if(z->level == ZOOM_BITS)
+        return;
+
+    /* The old centre is on the old grid too, so these are exact */
+    nx = snap(x, z->level);
+    ny = snap(y, z->level);
+    di = (nx - z->x) / s;
+    dj = (ny - z->y) / s;
+
+    memcpy(old, z->counts, sizeof(old));
+    z->x = nx;
+    z->y = ny;
+    z->level++;
+
+    for(int i = 0; i < 256; i++)
+    {
+        int oi = 128 + di + (i - 128) / 2;
+        int hit_i = zoom_reuse && !(i & 1) && oi >= 0 && oi < 256;
+
+        for(int j = 0; j < 256; j++)
+        {
+            int oj = 128 + dj + (j - 128) / 2;
+
+            if(hit_i && !(j & 1) && oj >= 0 && oj < 256) {
+                z->counts[i][j] = old[oi][oj];
+                z->reused++;
+            } else {
+                z->counts[i][j] = sample(z, i, j);
+                z->computed++;
+            }
+        }
+    }
+}
+
+/* Continue a sequence from a level already built, as a twiddled texture
+   like zoom_store() writes */
+void zoom_load(zoom_seq *z, int formula, int level, double x, double y, const uint8_t *src)
+{
+    z->formula = formula;
+    z->level = level;
+    z->x = snap(x, level);
+    z->y = snap(y, level);
+
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            z->counts[i][j] = src[twiddletab[i] << 1 | twiddletab[j]];
+}
+
+/* Twiddled PAL8, like fractal_store_block() leaves it */
+void zoom_store(const zoom_seq *z, uint8_t *dst)
+{
+    for(int i = 0; i < 256; i++)
+        for(int j = 0; j < 256; j++)
+            dst[twiddletab[i] << 1 | twiddletab[j]] = z->counts[i][j];
+}
@@ -0,0 +1,41 @@
+#ifndef ZOOM_H_INCLUDED
+#define ZOOM_H_INCLUDED
+
+#include <stdint.h>
+
+/*
+  Zoom sequences with grid reuse, for host tools
+
+  Level L of a zoom samples compute_sample() every 2^-L level 0 texels
+  around a centre, 256x256 texels with the centre at texel (128, 128).
+  Positions are kept in fixed point, ZOOM_BITS fraction bits of a level
+  0 texel, so every coordinate is exact and a point gives the same
+  double, and the same count, at any level.
+
+  zoom_step() goes to level L+1 with the centre snapped to the level L
+  texel nearest the target. Then the new texels (i, j) with i and j
+  both even sit exactly on old texels and their counts are copied; only
+  the rest are computed. That is a quarter of the texels, less the ones
+  that fall outside the old grid when the centre moves.
+*/
+
+#define ZOOM_BITS 32
+
+typedef struct
+{
+    int formula;
+    int level;
+    int64_t x, y;               /* centre, ZOOM_BITS fixed point */
+    uint8_t counts[256][256];   /* [i][j], i along x */
+    uint32_t computed, reused;  /* texels, whole sequence */
+} zoom_seq;
+
+/* 0 computes every texel of a step, for comparison */
+extern int zoom_reuse;
+
+void zoom_start(zoom_seq *z, int formula, double x, double y);
+void zoom_step(zoom_seq *z, double x, double y);
+void zoom_load(zoom_seq *z, int formula, int level, double x, double y, const uint8_t *src);
+void zoom_store(const zoom_seq *z, uint8_t *dst);
+
+#endif /* ZOOM_H_INCLUDED */